@@ -7,6 +7,7 @@
 
 #include <decomp_util/decomp_geometry/ellipsoid.h>
 #include <decomp_util/decomp_geometry/polyhedron.h>
+#include <decomp_util/decomp_basis/point_grid.h>
 // #include <decomp_geometry/geometry_utils.h>
 #include <ros_tools/profiling.h>
 
@@ -51,6 +52,30 @@ class DecompBase {
       }
     }
 
+    ///Import obstacle points from a grid, only the cells around the local bbox are visited
+    void set_obs(const PointGrid<Dim> &grid) {
+      vec_Vecf<Dim> candidates;
+      std::vector<int> indices;
+      set_obs(grid, candidates, indices);
+    }
+
+    ///Import obstacle points from a grid, with buffers for the candidate points and their indices (reused between calls)
+    void set_obs(const PointGrid<Dim> &grid, vec_Vecf<Dim> &candidates, std::vector<int> &indices) {
+      Polyhedron<Dim> vs;
+      add_local_bbox(vs);
+
+      Vecf<Dim> min, max;
+      if (!local_bbox_bounds(min, max)) {
+        obs_ = vs.points_inside(grid.points());
+        return;
+      }
+
+      PROFILE_SCOPE("points inside (grid)");
+      candidates.clear();
+      grid.points_in_box(min, max, candidates, indices);
+      obs_ = vs.points_inside(candidates);
+    }
+
     ///Import obstacle points
     void set_obs_ptr(const vec_Vecf<Dim>* obs) {
       // only consider points inside local bbox
@@ -85,6 +110,9 @@ class DecompBase {
  protected:
     virtual void add_local_bbox(Polyhedron<Dim> &Vs) = 0;
 
+    ///Axis-aligned box around the local bbox, false if there is no local bbox (all points are inside)
+    virtual bool local_bbox_bounds(Vecf<Dim> &/*min*/, Vecf<Dim> &/*max*/) const { return false; }
+
     void find_polyhedron() {
       //**** find half-space
       Polyhedron<Dim> Vs;
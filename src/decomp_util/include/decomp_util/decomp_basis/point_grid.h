@@ -0,0 +1,164 @@
+/**
+ * @file point_grid.h
+ * @brief PointGrid Class
+ */
+#ifndef POINT_GRID_H
+#define POINT_GRID_H
+
+#include <decomp_util/decomp_basis/data_type.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief Uniform grid over a set of points, for axis-aligned box queries
+ *
+ * The points are bucketed by cell once (counting sort), a query only visits the cells that overlap the box. The cell
+ * size follows from the density of the points (a few points per cell on average), so that a query scales with the
+ * number of points near the box rather than with the total number of points.
+ */
+template <int Dim>
+class PointGrid {
+  public:
+    ///Null constructor
+    PointGrid() {}
+
+    /**
+     * @brief Bucket the points (they are referenced, not copied)
+     * @param points Must outlive the grid or the next build
+     * @param points_per_cell Average number of points per occupied volume that the cell size aims for
+     */
+    void build(const vec_Vecf<Dim> &points, decimal_t points_per_cell = 4) {
+      points_ = &points;
+      cell_start_.clear();
+      indices_.clear();
+      if (points.empty())
+        return;
+
+      min_ = points[0];
+      Vecf<Dim> max = points[0];
+      for (const auto &it : points) {
+        min_ = min_.cwiseMin(it);
+        max = max.cwiseMax(it);
+      }
+
+      // Cell size from the volume per point, bounded so that the grid does not get much larger than the point set
+      const Vecf<Dim> extent = (max - min_).cwiseMax(1e-6);
+      const decimal_t volume = extent.prod();
+      cell_size_ = std::pow(volume * points_per_cell / (decimal_t)points.size(), 1. / Dim);
+      cell_size_ = std::max(cell_size_, extent.maxCoeff() / 1024.);
+      int num_cells;
+      for (;;) {
+        num_cells = 1;
+        for (int d = 0; d < Dim; d++) {
+          size_[d] = (int)(extent(d) / cell_size_) + 1;
+          num_cells *= size_[d];
+        }
+        if (num_cells <= std::max<int>(1024, 4 * points.size()))
+          break;
+        cell_size_ *= 2;
+      }
+
+      // Counting sort of the point indices by cell (stable, so each cell keeps the original order)
+      cell_start_.assign(num_cells + 1, 0);
+      std::vector<int> point_cells(points.size());
+      for (size_t i = 0; i < points.size(); i++) {
+        point_cells[i] = cell_index(points[i]);
+        cell_start_[point_cells[i] + 1]++;
+      }
+      for (int c = 0; c < num_cells; c++)
+        cell_start_[c + 1] += cell_start_[c];
+
+      indices_.resize(points.size());
+      std::vector<int> fill(cell_start_.begin(), cell_start_.end() - 1);
+      for (size_t i = 0; i < points.size(); i++)
+        indices_[fill[point_cells[i]]++] = i;
+    }
+
+    ///The indexed points
+    const vec_Vecf<Dim> &points() const { return *points_; }
+
+    ///True if build was called with at least one point
+    bool empty() const { return indices_.empty(); }
+
+    /**
+     * @brief Points inside the axis-aligned box [min, max] (non-exclusive), in their original order
+     * @param min Lower corner of the box
+     * @param max Upper corner of the box
+     * @param O Output, the points are appended
+     */
+    void points_in_box(const Vecf<Dim> &min, const Vecf<Dim> &max, vec_Vecf<Dim> &O) const {
+      std::vector<int> found;
+      points_in_box(min, max, O, found);
+    }
+
+    ///As above, with a buffer for the indices of the found points that is reused between calls
+    void points_in_box(const Vecf<Dim> &min, const Vecf<Dim> &max, vec_Vecf<Dim> &O, std::vector<int> &found) const {
+      found.clear();
+      if (empty())
+        return;
+
+      int lower[Dim], upper[Dim];
+      for (int d = 0; d < Dim; d++) {
+        const decimal_t lower_cell = std::floor((min(d) - min_(d)) / cell_size_);
+        const decimal_t upper_cell = std::floor((max(d) - min_(d)) / cell_size_);
+        if (upper_cell < 0 || lower_cell > size_[d] - 1 || lower_cell > upper_cell)
+          return;
+        lower[d] = (int)std::max<decimal_t>(0, lower_cell);
+        upper[d] = (int)std::min<decimal_t>(size_[d] - 1, upper_cell);
+      }
+
+      // Visit the cells of the box (odometer over the dimensions)
+      int cell[Dim];
+      std::copy(lower, lower + Dim, cell);
+      for (;;) {
+        int c = 0;
+        for (int d = Dim - 1; d >= 0; d--)
+          c = c * size_[d] + cell[d];
+
+        for (int i = cell_start_[c]; i < cell_start_[c + 1]; i++) {
+          const auto &pt = (*points_)[indices_[i]];
+          if ((pt.array() >= min.array()).all() && (pt.array() <= max.array()).all())
+            found.push_back(indices_[i]);
+        }
+
+        int d = 0;
+        for (; d < Dim; d++) {
+          if (++cell[d] <= upper[d])
+            break;
+          cell[d] = lower[d];
+        }
+        if (d == Dim)
+          break;
+      }
+
+      std::sort(found.begin(), found.end());
+      O.reserve(O.size() + found.size());
+      for (int i : found)
+        O.push_back((*points_)[i]);
+    }
+
+  private:
+    int cell_index(const Vecf<Dim> &pt) const {
+      int c = 0;
+      for (int d = Dim - 1; d >= 0; d--)
+        c = c * size_[d] + std::min(size_[d] - 1, (int)((pt(d) - min_(d)) / cell_size_));
+      return c;
+    }
+
+    const vec_Vecf<Dim> *points_{nullptr};
+
+    Vecf<Dim> min_{Vecf<Dim>::Zero()};
+    decimal_t cell_size_{1};
+    int size_[Dim];
+
+    /// Points of cell c: indices_[cell_start_[c]] ... indices_[cell_start_[c + 1] - 1]
+    std::vector<int> cell_start_;
+    std::vector<int> indices_;
+};
+
+typedef PointGrid<2> PointGrid2D;
+
+typedef PointGrid<3> PointGrid3D;
+#endif
@@ -20,6 +20,11 @@ struct Ellipsoid {
     return (C_.inverse() * (pt - d_)).norm();
   }
 
+  /// Calculate distance to the center, with the inverse of C computed once by the caller
+  decimal_t dist(const Vecf<Dim>& pt, const Matf<Dim, Dim>& C_inv) const {
+    return (C_inv * (pt - d_)).norm();
+  }
+
   /// Check if the point is inside, non-exclusive
   bool inside(const Vecf<Dim>& pt) const {
       return dist(pt) <= 1;
@@ -29,8 +34,9 @@ struct Ellipsoid {
   vec_Vecf<Dim> points_inside(const vec_Vecf<Dim> &O) const {
     vec_Vecf<Dim> new_O;
     new_O.reserve(O.size());
+    const Matf<Dim, Dim> C_inv = C_.inverse();
     for (const auto &it : O) {
-      if (inside(it))
+      if (dist(it, C_inv) <= 1)
         new_O.emplace_back(it);
     }
     return new_O;
@@ -40,8 +46,9 @@ struct Ellipsoid {
   Vecf<Dim> closest_point(const vec_Vecf<Dim> &O) const {
     Vecf<Dim> pt = Vecf<Dim>::Zero();
     decimal_t min_dist = std::numeric_limits<decimal_t>::max();
+    const Matf<Dim, Dim> C_inv = C_.inverse();
     for (const auto &it : O) {
-      decimal_t d = dist(it);
+      decimal_t d = dist(it, C_inv);
       if (d < min_dist) {
         min_dist = d;
         pt = it;
@@ -8,8 +8,11 @@
 #include <memory>
 #include <thread>
 #include <decomp_util/line_segment.h>
+#include <decomp_util/thread_pool.h>
 #include <ros_tools/profiling.h>
 
+#include <algorithm>
+
 /**
  * @brief EllipsoidDecomp Class
  *
@@ -36,12 +39,32 @@ public:
     global_bbox_max_ = origin + dim;
   }
 
-  /// Set obstacle points
-  void set_obs(const vec_Vecf<Dim> &obs) { obs_ = obs; }
+  /// Set obstacle points and index them for the queries of the line segments
+  void set_obs(const vec_Vecf<Dim> &obs)
+  {
+    obs_ = obs;
+    obs_grid_.build(obs_);
+  }
 
   /// Set dimension of bounding box
   void set_local_bbox(const Vecf<Dim> &bbox) { local_bbox_ = bbox; }
 
+  /**
+   * @brief Dilate the line segments on a persistent pool of worker threads
+   * @param num_threads Number of workers, 1 dilates on the calling thread
+   *
+   * Each worker dilates a contiguous range of segments with its own scratch buffer. Every segment writes its own
+   * ellipsoid and polyhedron, so the output does not depend on the number of threads.
+   */
+  void set_num_threads(int num_threads)
+  {
+    num_threads_ = std::max(1, num_threads);
+    thread_pool_.reset();
+    if (num_threads_ > 1)
+      thread_pool_ = std::make_unique<ThreadPool>(num_threads_);
+    scratch_.resize(num_threads_);
+  }
+
   /**
    * @brief Tighten polyhedron i with a specified distance seen from the perspective of a point inside the polyhedron
    *
@@ -187,19 +210,36 @@ public:
     polyhedrons_.resize(n_segments);
 
     // Create line segments and corresponding ellipsoids and polyhedrons based on a path with ellipsoidal and circular elements
-    unsigned int idx_path = 0;
-    for (unsigned int i = 0; i < n_segments; i++)
+    auto dilate_segments = [&](int worker, unsigned int begin, unsigned int end)
     {
-      lines_[i] = std::make_shared<LineSegment<Dim>>(path[idx_path], path[idx_path + 1]);
-      lines_[i]->set_local_bbox(local_bbox_);
-      lines_[i]->set_obs(obs_);
-      lines_[i]->dilate(offset_x);
-      ellipsoids_[i] = lines_[i]->get_ellipsoid();
-      polyhedrons_[i] = lines_[i]->get_polyhedron();
+      for (unsigned int i = begin; i < end; i++)
+      {
+        const unsigned int idx_path = is_path_circle_only_ ? 2 * i : i; // Extra increase in case of circular elements
+
+        lines_[i] = std::make_shared<LineSegment<Dim>>(path[idx_path], path[idx_path + 1]);
+        lines_[i]->set_local_bbox(local_bbox_);
+        lines_[i]->set_obs(obs_grid_, scratch_[worker].candidates, scratch_[worker].indices);
+        lines_[i]->dilate(offset_x);
+        ellipsoids_[i] = lines_[i]->get_ellipsoid();
+        polyhedrons_[i] = lines_[i]->get_polyhedron();
+      }
+    };
 
-      if (is_path_circle_only_)
-        idx_path++;
-      idx_path++;
+    const int num_workers = std::min<int>(num_threads_, n_segments);
+    if (!thread_pool_ || num_workers <= 1)
+    {
+      dilate_segments(0, 0, n_segments);
+    }
+    else
+    {
+      for (int w = 0; w < num_workers; w++)
+      {
+        thread_pool_->enqueue([&, w]()
+                              {
+                                dilate_segments(w, w * n_segments / num_workers, (w + 1) * n_segments / num_workers);
+                                thread_pool_->taskDone(); });
+      }
+      thread_pool_->waitUntilFinished();
     }
 
     path_ = path;
@@ -262,6 +302,16 @@ protected:
   vec_Vecf<Dim> path_;
   bool is_path_circle_only_;
   vec_Vecf<Dim> obs_;
+  PointGrid<Dim> obs_grid_; // Over obs_ (refers to it, rebuilt by set_obs)
+
+  int num_threads_{1};
+  std::unique_ptr<ThreadPool> thread_pool_;                          // Persistent workers (if num_threads_ > 1)
+  struct Scratch
+  {
+    vec_Vecf<Dim> candidates; // Points in the box around a segment
+    std::vector<int> indices; // Their indices in the grid
+  };
+  std::vector<Scratch> scratch_ = std::vector<Scratch>(1); // Of each worker
 
   vec_E<Ellipsoid<Dim>> ellipsoids_;
   vec_E<Polyhedron<Dim>> polyhedrons_;
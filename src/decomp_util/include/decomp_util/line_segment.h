@@ -111,6 +111,18 @@ protected:
     }
   }
 
+  /// The local bbox extends at most its diagonal from the line segment
+  bool local_bbox_bounds(Vecf<Dim> &min, Vecf<Dim> &max) const
+  {
+    if ((this->local_bbox_.array() == 0).all())
+      return false;
+
+    const decimal_t reach = this->local_bbox_.norm();
+    min = p1_.cwiseMin(p2_).array() - reach;
+    max = p1_.cwiseMax(p2_).array() + reach;
+    return true;
+  }
+
   /// Find ellipsoid in 2D
   template <int U = Dim>
   typename std::enable_if<U == 2>::type
@@ -150,9 +162,10 @@ protected:
       E.C_ = Ri * new_C * Ri.transpose();
 
       vec_Vecf<Dim> obs_new;
+      const Matf<Dim, Dim> C_inv = E.C_.inverse();
       for (const auto &it : obs_inside)
       {
-        if (1 - E.dist(it) > epsilon_)
+        if (1 - E.dist(it, C_inv) > epsilon_)
           obs_new.emplace_back(it);
       }
       obs_inside = obs_new;
@@ -205,9 +218,10 @@ protected:
       E.C_ = Rf * new_C * Rf.transpose();
 
       vec_Vecf<Dim> obs_new;
+      const Matf<Dim, Dim> C_inv = E.C_.inverse();
       for (const auto &it : obs_inside)
       {
-        if (1 - E.dist(it) > epsilon_)
+        if (1 - E.dist(it, C_inv) > epsilon_)
           obs_new.push_back(it);
       }
       obs_inside = obs_new;
@@ -236,9 +250,10 @@ protected:
       E.C_ = Rf * new_C * Rf.transpose();
 
       vec_Vecf<Dim> obs_new;
+      const Matf<Dim, Dim> C_inv = E.C_.inverse();
       for (const auto &it : obs_inside)
       {
-        if (1 - E.dist(it) > epsilon_)
+        if (1 - E.dist(it, C_inv) > epsilon_)
           obs_new.push_back(it);
       }
       obs_inside = obs_new;
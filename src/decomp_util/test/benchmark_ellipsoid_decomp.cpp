@@ -0,0 +1,110 @@
+/**
+ * @file benchmark_ellipsoid_decomp.cpp
+ * @brief Times EllipsoidDecomp::dilate with 1, 2, 4 and 8 threads on the test_ellipsoid_decomp scenario (its
+ * obstacles and path) and on the same obstacles sampled as costmap cells along a path of planner length
+ * Usage: benchmark_ellipsoid_decomp obstacles.txt [segments] [repetitions]
+ */
+#include <decomp_util/ellipsoid_decomp.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+bool read_obstacles(const char *file_name, vec_Vec2f &obs) {
+  std::ifstream file(file_name);
+  double x, y;
+  while (file >> x >> y)
+    obs.emplace_back(x, y);
+  return !obs.empty();
+}
+
+/// Average time of a dilation [ms], the polyhedrons are compared with those of the first run
+double time_dilation(EllipsoidDecomp2D &decomp, const vec_Vec2f &path, int repetitions,
+                     vec_E<Polyhedron2D> &reference) {
+  decomp.dilate(path, 0); // Warm up (starts the workers)
+
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repetitions; r++)
+    decomp.dilate(path, 0);
+  double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repetitions;
+
+  const auto polyhedrons = decomp.get_polyhedrons();
+  if (reference.empty())
+    reference = polyhedrons;
+
+  for (size_t i = 0; i < polyhedrons.size(); i++) {
+    const auto &a = polyhedrons[i].hyperplanes();
+    const auto &b = reference[i].hyperplanes();
+    bool equal = a.size() == b.size();
+    for (size_t j = 0; equal && j < a.size(); j++)
+      equal = a[j].p_ == b[j].p_ && a[j].n_ == b[j].n_;
+    if (!equal) {
+      printf("Polyhedron %zu differs from the single threaded result\n", i);
+      std::exit(1);
+    }
+  }
+  return time * 1000.;
+}
+
+void run(const char *name, const vec_Vec2f &obs, const vec_Vec2f &path, const Vec2f &local_bbox, int repetitions) {
+  printf("%s: %zu obstacles, %zu segments\n", name, obs.size(), path.size() - 1);
+
+  vec_E<Polyhedron2D> reference;
+  double single_threaded = 0.;
+  for (int threads : {1, 2, 4, 8}) {
+    EllipsoidDecomp2D decomp;
+    decomp.set_local_bbox(local_bbox);
+    decomp.set_num_threads(threads);
+    decomp.set_obs(obs);
+
+    double time = time_dilation(decomp, path, repetitions, reference);
+    if (threads == 1)
+      single_threaded = time;
+    printf("  %d thread(s): %8.3f ms (speedup %.2f)\n", threads, time, single_threaded / time);
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    printf("Input txt file required!\n");
+    return -1;
+  }
+
+  vec_Vec2f obs;
+  if (!read_obstacles(argv[1], obs)) {
+    printf("Cannot find input file [%s]!\n", argv[1]);
+    return -1;
+  }
+  const int segments = argc > 2 ? std::atoi(argv[2]) : 30;
+  const int repetitions = argc > 3 ? std::atoi(argv[3]) : 200;
+
+  // The scenario of test_ellipsoid_decomp
+  vec_Vec2f path;
+  path.push_back(Vec2f(1, 1.0));
+  path.push_back(Vec2f(0.0, 0.0));
+  path.push_back(Vec2f(-1, 1.0));
+  run("test_ellipsoid_decomp", obs, path, Vec2f(2, 2), repetitions);
+
+  // The obstacles as occupied 5 cm cells (a disc of 0.3 m around each), with a path of planner length through the map
+  vec_Vec2f cells;
+  const double resolution = 0.05;
+  for (const auto &it : obs) {
+    for (double dx = -0.3; dx <= 0.3; dx += resolution) {
+      for (double dy = -0.3; dy <= 0.3; dy += resolution) {
+        if (dx * dx + dy * dy <= 0.09)
+          cells.emplace_back(it(0) + dx, it(1) + dy);
+      }
+    }
+  }
+
+  vec_Vec2f long_path;
+  for (int k = 0; k <= segments; k++) {
+    double t = (double)k / segments;
+    long_path.push_back(Vec2f(-1.5 + 3. * t, 0.5 + 0.5 * std::sin(3. * t)));
+  }
+  run("costmap cells", cells, long_path, Vec2f(2, 2), repetitions);
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file test_point_grid.cpp
+ * @brief Checks that PointGrid::points_in_box and the dilation of EllipsoidDecomp (which queries the grid) give the
+ * same results as the linear points_inside path
+ */
+#include <decomp_util/ellipsoid_decomp.h>
+
+#include <cstdio>
+#include <random>
+
+int failures = 0;
+
+#define CHECK(condition, ...)      \
+  if (!(condition)) {              \
+    printf("FAILED: " __VA_ARGS__); \
+    printf("\n");                  \
+    failures++;                    \
+  }
+
+bool equal(const vec_E<Hyperplane2D> &a, const vec_E<Hyperplane2D> &b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t j = 0; j < a.size(); j++) {
+    if (a[j].p_ != b[j].p_ || a[j].n_ != b[j].n_)
+      return false;
+  }
+  return true;
+}
+
+/// Points in [min, max] (non-exclusive) by checking every point
+template <int Dim>
+vec_Vecf<Dim> points_in_box_linear(const vec_Vecf<Dim> &points, const Vecf<Dim> &min, const Vecf<Dim> &max) {
+  vec_Vecf<Dim> inside;
+  for (const auto &it : points) {
+    if ((it.array() >= min.array()).all() && (it.array() <= max.array()).all())
+      inside.push_back(it);
+  }
+  return inside;
+}
+
+/// Uniform points with a dense cluster (as occupied costmap cells)
+template <int Dim>
+vec_Vecf<Dim> random_points(std::mt19937 &generator, int n) {
+  std::uniform_real_distribution<double> uniform(-10., 10.);
+  vec_Vecf<Dim> points;
+  for (int i = 0; i < n; i++) {
+    Vecf<Dim> pt;
+    for (int d = 0; d < Dim; d++)
+      pt(d) = uniform(generator);
+    points.push_back(pt);
+  }
+  for (int i = 0; i < n / 4; i++) {
+    Vecf<Dim> pt = Vecf<Dim>::Constant(2.);
+    pt(0) += 0.05 * (i % 50);
+    pt(1) += 0.05 * (i / 50);
+    points.push_back(pt);
+  }
+  return points;
+}
+
+template <int Dim>
+void test_points_in_box(std::mt19937 &generator) {
+  std::uniform_real_distribution<double> center(-12., 12.), half_size(0., 4.);
+
+  for (int n : {0, 1, 10, 1000, 10000}) {
+    vec_Vecf<Dim> points = random_points<Dim>(generator, n);
+    PointGrid<Dim> grid;
+    grid.build(points);
+    CHECK(grid.empty() == points.empty(), "%dD grid of %zu points is empty", Dim, points.size());
+
+    std::vector<int> indices;
+
+    for (int query = 0; query < 200; query++) {
+      Vecf<Dim> min, max;
+      for (int d = 0; d < Dim; d++) {
+        const double c = center(generator), h = query % 10 == 0 ? 0. : half_size(generator); // Also a single point
+        min(d) = c - h;
+        max(d) = c + h;
+      }
+      if (query % 20 == 1 && !points.empty()) { // Exactly on a point
+        min = points[query % points.size()];
+        max = min;
+      }
+
+      vec_Vecf<Dim> found;
+      if (query % 2 == 0)
+        grid.points_in_box(min, max, found);
+      else
+        grid.points_in_box(min, max, found, indices); // Reused buffer
+      const vec_Vecf<Dim> expected = points_in_box_linear(points, min, max);
+      CHECK(found.size() == expected.size(), "%dD box query %d of %zu points found %zu instead of %zu points", Dim,
+            query, points.size(), found.size(), expected.size());
+      for (size_t i = 0; i < std::min(found.size(), expected.size()); i++) {
+        CHECK(found[i] == expected[i], "%dD box query %d of %zu points differs at point %zu (order)", Dim, query,
+              points.size(), i);
+      }
+    }
+  }
+}
+
+void test_dilation(std::mt19937 &generator) {
+  std::uniform_real_distribution<double> uniform(-5., 5.);
+
+  for (int trial = 0; trial < 20; trial++) {
+    const vec_Vec2f obs = random_points<2>(generator, trial * 200);
+
+    vec_Vec2f path;
+    Vec2f pt(uniform(generator), uniform(generator));
+    for (int k = 0; k < 12; k++) {
+      path.push_back(pt);
+      pt += Vec2f(0.4, 0.1 * std::sin(k));
+    }
+
+    // Without a local bbox the grid is not used
+    const double range = trial % 5 == 0 ? 0. : 2.5;
+
+    EllipsoidDecomp2D decomp;
+    decomp.set_local_bbox(Vec2f(range, range));
+    decomp.set_obs(obs);
+    decomp.dilate(path, 0);
+    const auto polyhedrons = decomp.get_polyhedrons();
+    CHECK(polyhedrons.size() == path.size() - 1, "trial %d has %zu polyhedrons", trial, polyhedrons.size());
+
+    for (size_t i = 0; i + 1 < path.size() && i < polyhedrons.size(); i++) {
+      LineSegment2D line(path[i], path[i + 1]);
+      line.set_local_bbox(Vec2f(range, range));
+      line.set_obs(obs); // Linear
+      line.dilate(0);
+
+      LineSegment2D grid_line(path[i], path[i + 1]);
+      grid_line.set_local_bbox(Vec2f(range, range));
+      PointGrid2D grid;
+      grid.build(obs);
+      grid_line.set_obs(grid);
+      CHECK(grid_line.get_obs() == line.get_obs(), "trial %d segment %zu imports other points from the grid", trial, i);
+
+      CHECK(equal(polyhedrons[i].hyperplanes(), line.get_polyhedron().hyperplanes()),
+            "trial %d polyhedron %zu differs from the linear dilation", trial, i);
+    }
+  }
+}
+
+int main() {
+  std::mt19937 generator(4);
+
+  test_points_in_box<2>(generator);
+  test_points_in_box<3>(generator);
+  test_dilation(generator);
+
+  if (failures > 0) {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("All checks passed\n");
+  return 0;
+}
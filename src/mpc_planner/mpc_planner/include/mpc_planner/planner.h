@@ -4,45 +4,117 @@
 #include <mpc_planner_types/data_types.h>
 #include <mpc_planner_types/module_data.h>
 
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
+namespace RosTools
+{
+    class Benchmarker;
+}
+
 namespace MPCPlanner
 {
     class RealTimeData;
     class State;
     class ControllerModule;
     class Solver;
+    class WorkerPool;
+    class CycleScheduler;
+    class ModuleDispatch;
 
     struct PlannerOutput
     {
         Trajectory trajectory;
         bool success{false};
 
+        double preparation_time{0.}; // Solver preparation phase for this solution [s] (ran ahead of time in RTI split mode)
+        double feedback_time{0.};    // Solver feedback phase for this solution [s]
+
+        bool speculated{false}; // Modules and parameters were prepared during the previous cycle (pipelined mode)
+
         PlannerOutput(double dt, int N) : trajectory(dt, N) {}
 
         PlannerOutput() = default;
+
+        /** @brief Clear the solution for a new planning iteration, keeping the allocated trajectory */
+        void reset()
+        {
+            trajectory.clear();
+            success = false;
+            preparation_time = 0.;
+            feedback_time = 0.;
+            speculated = false;
+        }
     };
 
     class Planner
     {
     public:
         Planner();
+        ~Planner();
 
     public:
-        PlannerOutput solveMPC(State &state, RealTimeData &data);
+        /** @brief The output remains valid until the next call */
+        const PlannerOutput &solveMPC(State &state, RealTimeData &data);
+
+        /** @brief Call after publishing the command. In RTI split mode, runs the solver preparation phase for the next
+         * solveMPC. In pipelined mode, starts the module updates, parameters and preparation of the next cycle on a
+         * worker, from the predicted state and this cycle's data */
+        void prepareNextIteration(const RealTimeData &data);
         double getSolution(int k, std::string &&var_name) const;
 
+        /** @brief In pipelined mode, the modules receive the data at the start of the next solveMPC (the caller does not
+         * wait for the speculation, the data must still be in the RealTimeData passed to solveMPC) */
         void onDataReceived(RealTimeData &data, std::string &&data_name);
 
+        /** @brief With visualization.asynchronous, only copies what is visualized and draws it on the visualization
+         * thread (rate limited to visualization.max_rate, a request that was not taken yet is replaced). Modules that
+         * cannot copy what they draw (see ControllerModule::snapshotVisuals()) are still drawn on the calling thread */
         void visualize(const State &state, const RealTimeData &data);
 
         void reset(State &state, RealTimeData &data, bool success = true);
 
         bool isObjectiveReached(const State &state, const RealTimeData &data) const;
 
+        /** @brief Percentiles of the solve times and iterations over the last solves */
+        void printSolverStatistics() const;
+
+        /** @brief Write the recorded solves to a CSV file */
+        void saveSolverStatistics(const std::string &file) const;
+
+        /** @brief Average and maximum update time of each module */
+        void printModuleTimings() const;
+
     private:
         bool _is_data_ready{false}, _was_reset{true};
 
+        // Settings that are constant during operation (read once, lookups allocate)
+        double _control_period{0.05};
+        bool _shift_forward{false}, _debug_limits{false};
+
+        // Allocation check (debug, needs ros_tools built with TRACK_ALLOCATIONS)
+        int _cycle{0}, _allocation_warmup_cycles{-1};
+        bool _assert_no_allocations{false};
+
+        // Pipelined mode
+        struct Speculation;
+        std::unique_ptr<Speculation> _speculation;
+        bool _pipelined{false};
+        double _max_state_deviation{0.1};
+        std::vector<int> _module_states; // State variables that the modules compute (ModuleData::STATE)
+
+        // Data received while pipelined, the modules receive it at the start of the next cycle
+        std::mutex _received_mutex;
+        std::vector<std::string> _received_data;
+        bool _data_received{false}; // Data was delivered this cycle, which invalidates the speculation
+
+        // Asynchronous visualization
+        struct Visualization;
+        std::unique_ptr<Visualization> _visualization;
+        std::mutex _modules_mutex; // Held by the thread that uses the modules and solver (control or speculation)
+
         std::shared_ptr<Solver> _solver;
         PlannerOutput _output;
 
@@ -51,6 +123,32 @@ namespace MPCPlanner
         ModuleData _module_data;
 
         std::vector<std::shared_ptr<ControllerModule>> _modules;
+
+        // Module updates, grouped in levels that only depend on earlier levels (by ModuleData fields)
+        std::vector<std::vector<int>> _update_levels;
+        std::vector<RosTools::Benchmarker *> _update_timers; // Update time of each module
+        std::unique_ptr<WorkerPool> _update_workers;      // Runs the updates of one level concurrently (if enabled)
+        std::unique_ptr<WorkerPool> _parameter_workers;   // Each sets the parameters of a range of stages (if enabled)
+        std::unique_ptr<ModuleDispatch> _module_dispatch; // Module loops without virtual calls (if generated)
+
+        std::unique_ptr<CycleScheduler> _scheduler; // Deadline of the cycle and the time budget of the solver
+
+        void solve(State &state, RealTimeData &data);
+
+        void buildUpdateLevels();
+        void updateModules(State &state, const RealTimeData &data, ModuleData &module_data);
+        void setModuleParameters(const RealTimeData &data, ModuleData &module_data);
+        int solveWithinDeadline(RealTimeData &data);
+        State getPredictedState() const;
+
+        void startSpeculation(const RealTimeData &data);
+        bool finishSpeculation(const State &state);
+        void waitForSpeculation() const;
+        bool deliverReceivedData(RealTimeData &data);
+
+        void runVisualization();
+        void stopVisualization();
+        void draw(const State &state, const RealTimeData &data, const Trajectory &trajectory, const std::vector<double> &angles);
     };
 
 }
@@ -9,7 +9,7 @@
 #include <ros_tools/logging.h>
 #include <ros_tools/math.h>
 
-#include <numeric>
+#include <algorithm>
 
 namespace MPCPlanner
 {
@@ -50,7 +50,7 @@ namespace MPCPlanner
         {
                 return DynamicObstacle(
                     -1,
-                    Eigen::Vector2d(state.get("x") + 100., state.get("y") + 100.),
+                    Eigen::Vector2d(state.get(Layout::Var::X) + 100., state.get(Layout::Var::Y) + 100.),
                     0.,
                     0.);
         }
@@ -59,7 +59,7 @@ namespace MPCPlanner
         {
                 Prediction prediction;
                 double noise = 0.;
-                if (CONFIG["probabilistic"]["enable"].as<bool>())
+                if (CONFIG_SNAPSHOT.probabilistic)
                 {
                         prediction = Prediction(PredictionType::GAUSSIAN);
                         noise = 0.3;
@@ -72,7 +72,7 @@ namespace MPCPlanner
                 for (int i = 0; i < steps; i++)
                         prediction.modes[0].push_back(PredictionStep(position + velocity * dt * i, 0., noise, noise));
 
-                if (CONFIG["probabilistic"]["enable"].as<bool>())
+                if (CONFIG_SNAPSHOT.probabilistic)
                         propagatePredictionUncertainty(prediction);
 
                 return prediction;
@@ -80,49 +80,41 @@ namespace MPCPlanner
 
         void removeDistantObstacles(std::vector<DynamicObstacle> &obstacles, const State &state)
         {
-                std::vector<DynamicObstacle> nearby_obstacles;
-
                 const Eigen::Vector2d pos = state.getPos();
-                for (auto &obstacle : obstacles)
-                {
-                        if (RosTools::distance(pos, obstacle.position) < CONFIG["max_obstacle_distance"].as<double>())
-                                nearby_obstacles.push_back(obstacle);
-                }
+                double max_obstacle_distance = CONFIG_SNAPSHOT.max_obstacle_distance;
 
-                obstacles = nearby_obstacles;
+                // In place, the obstacles keep their memory
+                obstacles.erase(std::remove_if(obstacles.begin(), obstacles.end(), [&](const DynamicObstacle &obstacle)
+                                               { return RosTools::distance(pos, obstacle.position) >= max_obstacle_distance; }),
+                                obstacles.end());
         }
 
         void ensureObstacleSize(std::vector<DynamicObstacle> &obstacles, const State &state)
         {
-                size_t max_obstacles = CONFIG["max_obstacles"].as<int>();
-
-                // Create an index list
-                std::vector<int> indices;
-                indices.resize(obstacles.size());
-                std::iota(indices.begin(), indices.end(), 0);
+                const ConfigSnapshot &config = CONFIG_SNAPSHOT;
+                size_t max_obstacles = config.max_obstacles;
+                int N = config.N;
 
                 // If more, we sort and retrieve the closest obstacles
                 if (obstacles.size() > max_obstacles)
                 {
-                        std::vector<double> distances;
+                        thread_local std::vector<double> distances; // Reused between calls
                         LOG_MARK("Received " << obstacles.size() << " > " << max_obstacles << " obstacles. Keeping the closest.");
 
-                        Eigen::Vector2d obstacle_pos;
-
                         distances.clear();
+                        Eigen::Vector2d direction(std::cos(state.get(Layout::Var::PSI)), std::sin(state.get(Layout::Var::PSI)));
                         for (auto &obstacle : obstacles)
                         {
                                 double dist;
                                 double min_dist = 1e5;
 
-                                Eigen::Vector2d direction(std::cos(state.get("psi")), std::sin(state.get("psi")));
-                                for (int k = 0; k < CONFIG["N"].as<int>(); k++)
+                                for (int k = 0; k < N; k++)
                                 {
                                         // Linearly scaled
                                         dist = (double)(k + 1) * 0.6 *
                                                RosTools::distance(
                                                    obstacle.prediction.modes[0][k].position,
-                                                   state.getPos() + state.get("v") * (double)k * direction);
+                                                   state.getPos() + state.get(Layout::Var::V) * (double)k * direction);
 
                                         if (dist < min_dist)
                                                 min_dist = dist;
@@ -130,27 +122,21 @@ namespace MPCPlanner
                                 distances.push_back(min_dist);
                         }
 
-                        // Sort obstacles on distance
-                        std::sort(indices.begin(), indices.end(), [&](const int a, const int b)
-                                  { return (distances[a] < distances[b]); });
-
-                        // Keep the closest obstacles
-                        std::vector<DynamicObstacle> processed_obstacles;
-                        processed_obstacles.clear();
-
+                        // Move the closest obstacles to the front (in place, in order of distance) and drop the others
                         for (size_t v = 0; v < max_obstacles; v++)
-                                processed_obstacles.push_back(obstacles[indices[v]]);
-
-                        for (size_t i = 0; i < processed_obstacles.size(); i++) // Sequential IDs
                         {
-                                processed_obstacles[i].index = i;
-                        }
+                                size_t closest = std::min_element(distances.begin() + v, distances.end()) - distances.begin();
+                                std::swap(obstacles[v], obstacles[closest]);
+                                std::swap(distances[v], distances[closest]);
 
-                        obstacles = processed_obstacles;
+                                obstacles[v].index = v; // Sequential IDs
+                        }
+                        obstacles.erase(obstacles.begin() + max_obstacles, obstacles.end());
                 }
                 else if (obstacles.size() < max_obstacles)
                 {
                         LOG_MARK("Received " << obstacles.size() << " < " << max_obstacles << " obstacles. Adding dummies.");
+                        obstacles.reserve(max_obstacles);
 
                         for (size_t cur_size = obstacles.size(); cur_size < max_obstacles; cur_size++)
                         {
@@ -159,8 +145,8 @@ namespace MPCPlanner
                                 auto &obstacle = obstacles.back();
                                 obstacle.prediction = getConstantVelocityPrediction(obstacle.position,
                                                                                     Eigen::Vector2d(0., 0.),
-                                                                                    CONFIG["integrator_step"].as<double>(),
-                                                                                    CONFIG["N"].as<int>());
+                                                                                    config.integrator_step,
+                                                                                    N);
                         }
                 }
 
@@ -172,11 +158,11 @@ namespace MPCPlanner
                 if (prediction.type != PredictionType::GAUSSIAN)
                         return;
 
-                double dt = CONFIG["integrator_step"].as<double>();
+                double dt = CONFIG_SNAPSHOT.integrator_step;
                 double major = 0.;
                 double minor = 0.;
 
-                for (int k = 0; k < CONFIG["N"].as<int>(); k++)
+                for (int k = 0; k < CONFIG_SNAPSHOT.N; k++)
                 {
                         major = std::sqrt(std::pow(major, 2.0) + std::pow(prediction.modes[0][k].major_radius * dt, 2.));
                         minor = std::sqrt(std::pow(minor, 2.0) + std::pow(prediction.modes[0][k].minor_radius * dt, 2.));
@@ -27,6 +27,7 @@ namespace MPCPlanner
     void ExperimentUtil::update(const State &state, std::shared_ptr<Solver> solver, const RealTimeData &data)
     {
         // Save data of this control iteration
+        PROFILE_SCOPE("ExperimentUtil::update");
         LOG_MARK("ExperimentUtil::SaveData()");
 
         // Don't export if the obstacles aren't ready
@@ -38,10 +39,10 @@ namespace MPCPlanner
 
         // SAVE VEHICLE DATA
         _data_saver->AddData("vehicle_pose", state.getPos());
-        _data_saver->AddData("vehicle_orientation", state.get("psi"));
+        _data_saver->AddData("vehicle_orientation", state.get(Layout::Var::PSI));
 
         // Save the planned trajectory
-        for (int k = 0; k < CONFIG["N"].as<int>(); k++)
+        for (int k = 0; k < CONFIG_SNAPSHOT.N; k++)
             _data_saver->AddData("vehicle_plan_" + std::to_string(k), solver->getEgoPredictionPosition(k));
 
         // SAVE OBSTACLE DATA
@@ -83,7 +84,7 @@ namespace MPCPlanner
         // Add the duration (assume control frequency is constant)
         _data_saver->AddData(
             "metric_duration",
-            (_control_iteration - _iteration_at_last_reset) * (1.0 / CONFIG["control_frequency"].as<double>()));
+            (_control_iteration - _iteration_at_last_reset) * (1.0 / CONFIG_SNAPSHOT.control_frequency));
 
         _data_saver->AddData("metric_completed", (int)(objective_reached));
         _iteration_at_last_reset = _control_iteration;
@@ -1,9 +1,12 @@
 #include <mpc_planner/planner.h>
 
 #include <mpc_planner_modules/modules.h>
+#include <mpc_planner_modules/static_modules.h>
 
 #include <mpc_planner_types/realtime_data.h>
 #include <mpc_planner_solver/acados_solver_interface.h>
+#include <mpc_planner_solver/cycle_scheduler.h>
+#include <mpc_planner_solver/worker_pool.h>
 
 #include <mpc_planner_util/load_yaml.hpp>
 #include <mpc_planner_util/parameters.h>
@@ -11,27 +14,173 @@
 
 #include <ros_tools/visuals.h>
 #include <ros_tools/logging.h>
+#include <ros_tools/profiling.h>
+#include <ros_tools/allocations.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <future>
+#include <thread>
 
 namespace MPCPlanner
 {
+    /** @brief The next cycle, prepared on a worker while the command of this cycle is executed */
+    struct Planner::Speculation
+    {
+        std::future<bool> result; // False if the data was not ready
+
+        State predicted_state; // The state that the speculation assumes
+        State updated_state;   // The predicted state after the module updates (e.g., with the spline progress)
+        RealTimeData data;     // Snapshot of the data, the caller may modify its own copy
+        ModuleData module_data;
+    };
+
+    /** @brief Copies of what one cycle visualizes, drawn on a dedicated thread */
+    struct Planner::Visualization
+    {
+        struct Snapshot
+        {
+            State state;
+            RealTimeData data;
+            ModuleData module_data;
+            Trajectory trajectory;
+            std::vector<double> angles;
+            std::vector<int> modules; // Drawn from their copies (see ControllerModule::snapshotVisuals())
+        };
+
+        Snapshot pending; // Written by the control thread
+        Snapshot active;  // Drawn by the visualization thread
+        bool has_pending{false}, stop{false};
+        bool drawing{false}; // The modules' copies are in use, they are not taken again until the drawing is done
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::thread thread;
+
+        std::chrono::steady_clock::duration min_period{0};
+        std::chrono::steady_clock::time_point last_request;
+    };
 
     Planner::Planner()
     {
+        auto startup_start = std::chrono::steady_clock::now();
+
+        _control_period = 1. / CONFIG["control_frequency"].as<double>();
+        _shift_forward = CONFIG["shift_previous_solution_forward"].as<bool>() && CONFIG["enable_output"].as<bool>();
+        _debug_limits = CONFIG["debug_limits"].as<bool>();
+
+        if (CONFIG["pipelining"].IsDefined())
+        {
+            _pipelined = CONFIG["pipelining"]["enable"].as<bool>();
+            _max_state_deviation = CONFIG["pipelining"]["max_state_deviation"].as<double>();
+        }
+
         // Initialize the solver
         _solver = std::make_shared<Solver>();
         _solver->reset();
+        LOG_VALUE("Solver 0 created in [ms]", _solver->getCreationTime() * 1000.);
+
+        initializeModules(_modules, _solver); // Modules with their own solvers create them concurrently
+        buildUpdateLevels();
+
+        for (auto &module : _modules)
+        {
+            if (module->produces() & ModuleData::STATE)
+            {
+                for (int i : module->producedStates())
+                    _module_states.push_back(i);
+            }
+        }
+
+#ifdef MPC_PLANNER_STATIC_MODULES
+        // The generated module types run the modules in order on this thread
+        bool static_dispatch = !CONFIG["module_updates"].IsDefined() || !CONFIG["module_updates"]["static_dispatch"].IsDefined() ||
+                               CONFIG["module_updates"]["static_dispatch"].as<bool>();
+        if (static_dispatch && !_update_workers && !_parameter_workers)
+            _module_dispatch = std::make_unique<GeneratedModules>(_modules, _update_timers);
+#endif
+        LOG_VALUE("Module dispatch", (_module_dispatch ? "static" : "dynamic"));
+
+        CycleScheduler::Settings scheduler_settings;
+        scheduler_settings.control_period = _control_period;
+        if (CONFIG["scheduler"].IsDefined())
+        {
+            scheduler_settings.margin = CONFIG["scheduler"]["margin"].as<double>();
+            scheduler_settings.adapt_iterations = CONFIG["scheduler"]["adapt_iterations"].as<bool>();
+            scheduler_settings.target_utilization = CONFIG["scheduler"]["target_utilization"].as<double>();
+        }
+        _scheduler = std::make_unique<CycleScheduler>(scheduler_settings, _solver->getMaxIterations());
+
+        _output = PlannerOutput(_solver->dt, _solver->N);
+        if (RosTools::allocationTrackingEnabled() && CONFIG["debug_allocations"].IsDefined())
+        {
+            _allocation_warmup_cycles = CONFIG["debug_allocations"]["warmup_cycles"].as<int>();
+            _assert_no_allocations = CONFIG["debug_allocations"]["assert"].as<bool>();
+        }
+
+        if (CONFIG["visualization"]["asynchronous"].IsDefined() && CONFIG["visualization"]["asynchronous"].as<bool>())
+        {
+            _visualization = std::make_unique<Visualization>();
+            double max_rate = CONFIG["visualization"]["max_rate"].as<double>();
+            if (max_rate > 0.)
+                _visualization->min_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(1. / max_rate));
+
+            BENCHMARKERS.getBenchmarker("visualization"); // Created here, the visualization thread only uses it
+            _visualization->thread = std::thread(&Planner::runVisualization, this);
+        }
+
+        LOG_VALUE("Planner startup time [ms]", std::chrono::duration<double>(std::chrono::steady_clock::now() - startup_start).count() * 1000.);
+    }
 
-        initializeModules(_modules, _solver);
+    Planner::~Planner()
+    {
+        waitForSpeculation();
+        stopVisualization();
     }
 
     // Given real-time data, solve the MPC problem
-    PlannerOutput Planner::solveMPC(State &state, RealTimeData &data)
+    const PlannerOutput &Planner::solveMPC(State &state, RealTimeData &data)
+    {
+        // After the warm-up, the output, module data and module buffers are reused and no allocations should be needed
+        bool check_allocations = _allocation_warmup_cycles >= 0 && _cycle >= _allocation_warmup_cycles;
+
+        // Modules may allocate when they receive data, this happens before the allocation check
+        _data_received = deliverReceivedData(data);
+
+        size_t allocations_before = RosTools::threadAllocations().allocations;
+        _cycle++;
+
+        _scheduler->startCycle(data.planning_start_time);
+        solve(state, data);
+        _scheduler->endCycle();
+
+        if (check_allocations)
+        {
+            size_t allocations = RosTools::threadAllocations().allocations - allocations_before;
+            if (allocations > 0)
+            {
+                LOG_WARN_THROTTLE(1000, "Planner::solveMPC allocated " << allocations << " times");
+                ROSTOOLS_ASSERT(!_assert_no_allocations, "Planner::solveMPC should not allocate after the warm-up (debug_allocations)");
+            }
+        }
+        return _output;
+    }
+
+    void Planner::solve(State &state, RealTimeData &data)
     {
-        LOG_INFO("Planner::solveMPC");
+        PROFILE_SCOPE("Planner::solveMPC");
+        LOG_MARK("Planner::solveMPC");
         bool was_feasible = _output.success;
-        _output = PlannerOutput(_solver->dt, _solver->N);
+        bool speculated = finishSpeculation(state);
+        std::lock_guard<std::mutex> modules_lock(_modules_mutex);
+        _output.reset();
 
-        _module_data = ModuleData(); // Reset module data
+        if (speculated)
+            std::swap(_module_data, _speculation->module_data); // Both keep their memory for the next cycles
+        else
+            _module_data.reset();
 
         // Check if all modules have enough data
         _is_data_ready = true;
@@ -41,84 +190,306 @@ namespace MPCPlanner
 
         if (!_is_data_ready)
         {
-            ROS_WARN_STREAM_THROTTLE(3000, "Data is not ready, missing " + missing_data + "\b");
+            LOG_WARN_THROTTLE(3000, "Data is not ready, missing " << missing_data << "\b");
 
             _output.success = false;
-            return _output;
+            return;
         }
         else if (_was_reset)
         {
             _was_reset = false;
         }
 
-        ROS_INFO_STREAM("Data checked");
+        LOG_MARK("Data checked");
 
         int exit_flag;
+        if (speculated)
+        {
+            // Critical path: only the initial state changed since the speculation
+            for (int i : _module_states) // Keep the state variables that the modules computed (e.g., the spline progress)
+                state.set(i, _speculation->updated_state.get(i));
+            _solver->setXinit(state);
+
+            LOG_MARK("Solve optimization (speculated)");
+            exit_flag = solveWithinDeadline(data);
+        }
+        else
         {
+            // In RTI split mode the warmstart was loaded and linearized in prepareNextIteration()
+            bool is_prepared = _solver->isPrepared() && was_feasible;
+
             // Set the initial guess
-            bool shift_forward = CONFIG["shift_previous_solution_forward"].as<bool>() &&
-                                 CONFIG["enable_output"].as<bool>();
-            if (was_feasible)
-                _solver->initializeWarmstart(state, shift_forward);
-            else
+            if (!is_prepared)
             {
-                // _solver->initializeWithState(state);
-                _solver->initializeWithBraking(state);
+                if (was_feasible)
+                    _solver->initializeWarmstart(state, _shift_forward);
+                else
+                {
+                    // _solver->initializeWithState(state);
+                    _solver->initializeWithBraking(state);
+                }
             }
 
             _solver->setXinit(state); // Set the initial state
 
-            // Update all modules
-            {
-                ROS_INFO_STREAM("Updating modules");
+            _scheduler->startPhase(CycleScheduler::Phase::MODULE_UPDATE);
+            updateModules(state, data, _module_data);
+
+            _scheduler->startPhase(CycleScheduler::Phase::PARAMETERS);
+            setModuleParameters(data, _module_data);
+
+            if (!is_prepared)
+                _solver->loadWarmstart();
+
+            // Solve MPC
+            LOG_MARK("Solve optimization");
+            exit_flag = solveWithinDeadline(data);
+        }
+        _scheduler->startPhase(CycleScheduler::Phase::POST_PROCESSING);
+
+        _output.preparation_time = _solver->_info.preparation_time;
+        _output.feedback_time = _solver->_info.feedback_time;
+        _output.speculated = speculated;
+
+        if (!_solver->hasUsableSolution(exit_flag))
+        {
+            _output.success = false;
+            LOG_WARN_THROTTLE(500, "MPC failed: " << _solver->explainExitFlag(exit_flag));
+
+            return;
+        }
+
+        _output.success = true;
+        for (int k = 1; k < _solver->N; k++)
+            _output.trajectory.add(_solver->getOutput(k, Layout::Var::X), _solver->getOutput(k, Layout::Var::Y));
+
+        if (_output.success && _debug_limits)
+            _solver->printIfBoundLimited();
+
+        LOG_MARK("Planner::solveMPC done");
+    }
+
+    // The solver gets the time until the deadline of the cycle, minus the expected post-processing
+    int Planner::solveWithinDeadline(RealTimeData &data)
+    {
+        _scheduler->startPhase(CycleScheduler::Phase::SOLVE);
+        _solver->_params.solver_timeout = _scheduler->getSolverBudget();
+        _solver->setIterationLimit(_scheduler->getIterationLimit());
+        data.solver_deadline = _scheduler->getSolverDeadline(); // For modules that solve their own problems
+
+        int exit_flag = _solver->solve();
+        _scheduler->onSolved();
+        return exit_flag;
+    }
 
-                for (auto &module : _modules)
-                    module->update(state, data, _module_data);
+    void Planner::buildUpdateLevels()
+    {
+        // Module i comes after module j < i if the sequential order matters: one writes what the other reads or writes
+        std::vector<int> level(_modules.size(), 0);
+        for (size_t i = 0; i < _modules.size(); i++)
+        {
+            for (size_t j = 0; j < i; j++)
+            {
+                bool conflict = (_modules[j]->produces() & (_modules[i]->consumes() | _modules[i]->produces())) ||
+                                (_modules[j]->consumes() & _modules[i]->produces());
+                if (conflict)
+                    level[i] = std::max(level[i], level[j] + 1);
             }
+        }
+
+        _update_levels.clear();
+        for (size_t i = 0; i < _modules.size(); i++)
+        {
+            if (level[i] >= (int)_update_levels.size())
+                _update_levels.resize(level[i] + 1);
+            _update_levels[level[i]].push_back(i);
+        }
+
+        // Looked up once, a lookup builds the name (allocates) and the workers must not modify the map
+        _update_timers.clear();
+        for (auto &module : _modules)
+            _update_timers.push_back(&BENCHMARKERS.getBenchmarker("update: " + module->getName()));
+
+        size_t max_level_size = 0;
+        for (size_t l = 0; l < _update_levels.size(); l++)
+        {
+            std::string names;
+            for (int i : _update_levels[l])
+                names += _modules[i]->getName() + " ";
+            LOG_VALUE("Module updates (level " + std::to_string(l) + ")", names);
+            max_level_size = std::max(max_level_size, _update_levels[l].size());
+        }
+
+        bool parallel = CONFIG["module_updates"].IsDefined() && CONFIG["module_updates"]["parallel"].as<bool>();
+        if (parallel && max_level_size > 1)
+            _update_workers = std::make_unique<WorkerPool>(max_level_size);
+
+        // The stages can be split over threads when setting parameters (worthwhile for large N)
+        if (CONFIG["module_updates"].IsDefined() && CONFIG["module_updates"]["parameter_threads"].IsDefined())
+        {
+            int parameter_threads = std::min(CONFIG["module_updates"]["parameter_threads"].as<int>(), _solver->N);
+            if (parameter_threads > 1)
+                _parameter_workers = std::make_unique<WorkerPool>(parameter_threads);
+        }
+    }
+
+    void Planner::updateModules(State &state, const RealTimeData &data, ModuleData &module_data)
+    {
+        if (_module_dispatch)
+        {
+            _module_dispatch->update(state, data, module_data);
+            return;
+        }
+
+        // Update all modules
+        {
+            LOG_MARK("Updating modules");
 
+            auto update_module = [&](int i)
             {
-                ROS_INFO_STREAM("Setting parameters");
+                _update_timers[i]->start();
+                _modules[i]->update(state, data, module_data);
+                _update_timers[i]->stop();
+            };
 
-                for (int k = 0; k < _solver->N; k++)
+            for (auto &update_level : _update_levels)
+            {
+                if (_update_workers && update_level.size() > 1)
+                    _update_workers->run(update_level.size(), [&](int i)
+                                         { update_module(update_level[i]); });
+                else
                 {
-                    for (auto &module : _modules)
-                    {
-                        module->setParameters(data, _module_data, k);
-                    }
+                    for (int i : update_level)
+                        update_module(i);
                 }
             }
+        }
+    }
 
-            _solver->loadWarmstart();
+    void Planner::setModuleParameters(const RealTimeData &data, ModuleData &module_data)
+    {
+        if (_module_dispatch)
+        {
+            _module_dispatch->setParameters(data, module_data);
+            return;
+        }
 
-            // set solver_timeout
-            std::chrono::duration<double> used_time = std::chrono::system_clock::now() - data.planning_start_time;
-            _solver->_params.solver_timeout = 1. / CONFIG["control_frequency"].as<double>() - used_time.count() - 0.006;
+        LOG_MARK("Setting parameters");
 
-            // Solve MPC
-            ROS_INFO_STREAM("Solve optimization");
-            {
-                exit_flag = _solver->solve();
-            }
-        }
+        auto set_parameters = [&](int k_begin, int k_end)
+        {
+            for (auto &module : _modules)
+                module->setParametersRange(data, module_data, k_begin, k_end);
+        };
 
-        if (exit_flag != 1)
+        if (_parameter_workers)
         {
-            _output.success = false;
-            ROS_WARN_STREAM_THROTTLE(500, "MPC failed: " + _solver->explainExitFlag(exit_flag));
+            int num_ranges = _parameter_workers->numWorkers();
+            _parameter_workers->run(num_ranges, [&](int i)
+                                    { set_parameters(i * _solver->N / num_ranges, (i + 1) * _solver->N / num_ranges); });
+        }
+        else
+        {
+            set_parameters(0, _solver->N);
+        }
+    }
+
+    State Planner::getPredictedState() const
+    {
+        // Without a new state, the first stage of the (shifted) previous solution is used as initial state
+        State predicted_state;
+        for (int i = Layout::NUM_INPUTS; i < Layout::NUM_VARIABLES; i++)
+            predicted_state.set(i, _solver->getOutput(_shift_forward ? 1 : 0, i));
+        return predicted_state;
+    }
+
+    void Planner::prepareNextIteration(const RealTimeData &data)
+    {
+        if (!_output.success)
+            return;
 
-            return _output;
+        if (_pipelined)
+        {
+            startSpeculation(data);
+            return;
         }
 
-        _output.success = true;
-        for (int k = 1; k < _solver->N; k++)
-            _output.trajectory.add(_solver->getOutput(k, "x"), _solver->getOutput(k, "y"));
+        if (!_solver->isRtiSplit())
+            return;
 
-        if (_output.success && CONFIG["debug_limits"].as<bool>())
-            _solver->printIfBoundLimited();
+        PROFILE_SCOPE("Planner::prepareNextIteration");
+        std::lock_guard<std::mutex> modules_lock(_modules_mutex);
 
-        ROS_INFO_STREAM("Planner::solveMPC done");
+        State predicted_state = getPredictedState();
 
-        return _output;
+        _solver->initializeWarmstart(predicted_state, _shift_forward);
+        _solver->loadWarmstart();
+        _solver->prepare();
+    }
+
+    void Planner::startSpeculation(const RealTimeData &data)
+    {
+        if (!_speculation)
+            _speculation = std::make_unique<Speculation>();
+
+        Speculation &speculation = *_speculation;
+        speculation.data = data;
+        speculation.data.planning_start_time = std::chrono::system_clock::now(); // Module deadlines start now
+        speculation.predicted_state = getPredictedState();
+        speculation.updated_state = speculation.predicted_state;
+        speculation.module_data.reset();
+
+        // The worker owns the solver and the modules until finishSpeculation() / waitForSpeculation()
+        speculation.result = std::async(std::launch::async, [this, &speculation]()
+                                        {
+                                            PROFILE_SCOPE("Planner::Speculation");
+                                            std::lock_guard<std::mutex> modules_lock(_modules_mutex);
+
+                                            std::string missing_data;
+                                            for (auto &module : _modules)
+                                            {
+                                                if (!module->isDataReady(speculation.data, missing_data))
+                                                    return false;
+                                            }
+
+                                            _solver->initializeWarmstart(speculation.predicted_state, _shift_forward);
+                                            _solver->setXinit(speculation.predicted_state);
+
+                                            updateModules(speculation.updated_state, speculation.data, speculation.module_data);
+                                            setModuleParameters(speculation.data, speculation.module_data);
+
+                                            _solver->loadWarmstart();
+                                            if (_solver->isRtiSplit())
+                                                _solver->prepare(); // Linearize with the new parameters
+                                            return true; });
+    }
+
+    bool Planner::finishSpeculation(const State &state)
+    {
+        if (!_speculation || !_speculation->result.valid())
+            return false;
+
+        PROFILE_SCOPE("Planner::finishSpeculation");
+        bool updated = _speculation->result.get();
+        if (!updated)
+            return false;
+
+        // Stale: the data changed or the robot is not where the previous solution predicted it
+        bool stale = _data_received ||
+                     (state.getPos() - _speculation->predicted_state.getPos()).norm() > _max_state_deviation;
+        if (stale)
+        {
+            LOG_MARK("Speculation is stale, updating the modules again");
+            _solver->discardPreparation(); // Linearized around the wrong state or with the wrong data
+            return false;
+        }
+        return true;
+    }
+
+    void Planner::waitForSpeculation() const
+    {
+        if (_speculation && _speculation->result.valid())
+            _speculation->result.wait();
     }
 
     double Planner::getSolution(int k, std::string &&var_name) const
@@ -128,39 +499,166 @@ namespace MPCPlanner
 
     void Planner::onDataReceived(RealTimeData &data, std::string &&data_name)
     {
-        for (auto &module : _modules)
-            module->onDataReceived(data, std::forward<std::string>(data_name));
+        if (!_pipelined)
+        {
+            std::lock_guard<std::mutex> modules_lock(_modules_mutex);
+            for (auto &module : _modules)
+                module->onDataReceived(data, std::forward<std::string>(data_name));
+            return;
+        }
+
+        // The speculation may be using the modules, do not wait for it here
+        std::lock_guard<std::mutex> lock(_received_mutex);
+        if (std::find(_received_data.begin(), _received_data.end(), data_name) == _received_data.end())
+            _received_data.push_back(std::move(data_name));
+    }
+
+    bool Planner::deliverReceivedData(RealTimeData &data)
+    {
+        std::lock_guard<std::mutex> lock(_received_mutex);
+        if (_received_data.empty())
+            return false;
+
+        waitForSpeculation(); // The modules are in use by the speculation
+        std::lock_guard<std::mutex> modules_lock(_modules_mutex);
+        for (auto &data_name : _received_data) // The data holds the latest of each, it is received once
+        {
+            for (auto &module : _modules)
+                module->onDataReceived(data, std::string(data_name));
+        }
+        _received_data.clear();
+        return true;
     }
 
     void Planner::visualize(const State &state, const RealTimeData &data)
     {
         PROFILE_SCOPE("Planner::Visualize");
-        ROS_INFO_STREAM("Planner::visualize");
-        (void)state;
+        LOG_MARK("Planner::visualize");
+        waitForSpeculation();
 
-        for (auto &module : _modules)
-            module->visualize(data, _module_data);
+        if (!_visualization)
+        {
+            for (auto &module : _modules)
+            {
+                module->snapshotVisuals();
+                module->visualize(data, _module_data);
+            }
 
-        visualizeTrajectory(_output.trajectory, "planned_trajectory", true, 0.2);
+            std::vector<double> angles;
+            for (int k = 1; k < _solver->N; k++)
+                angles.emplace_back(_solver->getOutput(k, Layout::Var::PSI));
 
-        visualizeObstacles(data.dynamic_obstacles, "obstacles", true, 1.0);
-        visualizeObstaclePredictions(data.dynamic_obstacles, "obstacle_predictions", true);
-        visualizeRobotArea(state.getPos(), state.get("psi"), data.robot_area, "robot_area", true);
+            draw(state, data, _output.trajectory, angles);
+            return;
+        }
 
-        std::vector<double> angles;
+        Visualization &visualization = *_visualization;
+        auto now = std::chrono::steady_clock::now();
+        if (now - visualization.last_request < visualization.min_period)
+            return;
+
+        std::unique_lock<std::mutex> lock(visualization.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || visualization.drawing) // The visualization thread is taking or drawing the previous request
+            return;
+
+        // Copy assignments reuse the memory of the previous snapshot
+        auto &snapshot = visualization.pending;
+        snapshot.state = state;
+        snapshot.data = data;
+        snapshot.module_data = _module_data;
+        snapshot.trajectory = _output.trajectory;
+        snapshot.angles.resize(_solver->N - 1);
         for (int k = 1; k < _solver->N; k++)
-            angles.emplace_back(_solver->getOutput(k, "psi"));
+            snapshot.angles[k - 1] = _solver->getOutput(k, Layout::Var::PSI);
+
+        // The visualization thread only reads the modules' copies. Modules without copies are drawn here
+        snapshot.modules.clear();
+        for (size_t i = 0; i < _modules.size(); i++)
+        {
+            if (_modules[i]->snapshotVisuals())
+                snapshot.modules.push_back(i);
+            else
+                _modules[i]->visualize(data, _module_data);
+        }
+
+        visualization.has_pending = true; // Replaces a request that was not taken yet
+        visualization.last_request = now;
+        lock.unlock();
+        visualization.condition.notify_one();
+    }
+
+    void Planner::runVisualization()
+    {
+        Visualization &visualization = *_visualization;
+        auto &timer = BENCHMARKERS.getBenchmarker("visualization");
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(visualization.mutex);
+                visualization.condition.wait(lock, [&]()
+                                             { return visualization.has_pending || visualization.stop; });
+                if (visualization.stop)
+                    return;
+
+                std::swap(visualization.pending, visualization.active);
+                visualization.has_pending = false;
+                visualization.drawing = true;
+            }
+
+            // Only reads the snapshot and the modules' copies, the control thread keeps updating the modules meanwhile
+            timer.start();
+            const auto &snapshot = visualization.active;
+            for (int i : snapshot.modules)
+                _modules[i]->visualize(snapshot.data, snapshot.module_data);
+            draw(snapshot.state, snapshot.data, snapshot.trajectory, snapshot.angles);
+            timer.stop();
+
+            std::lock_guard<std::mutex> lock(visualization.mutex);
+            visualization.drawing = false;
+        }
+    }
+
+    void Planner::stopVisualization()
+    {
+        if (!_visualization)
+            return;
 
-        visualizeRectangularRobotArea(state.getPos(), state.get("psi"),
-                                      CONFIG["robot"]["length"].as<double>(), CONFIG["robot"]["width"].as<double>(),
+        {
+            std::lock_guard<std::mutex> lock(_visualization->mutex);
+            _visualization->stop = true;
+        }
+        _visualization->condition.notify_one();
+        _visualization->thread.join();
+    }
+
+    void Planner::draw(const State &state, const RealTimeData &data, const Trajectory &trajectory, const std::vector<double> &angles)
+    {
+        visualizeTrajectory(trajectory, "planned_trajectory", true, 0.2);
+
+        visualizeObstacles(data.dynamic_obstacles, "obstacles", true, 1.0);
+        visualizeObstaclePredictions(data.dynamic_obstacles, "obstacle_predictions", true);
+        visualizeRobotArea(state.getPos(), state.get(Layout::Var::PSI), data.robot_area, "robot_area", true);
+
+        visualizeRectangularRobotArea(state.getPos(), state.get(Layout::Var::PSI),
+                                      CONFIG_SNAPSHOT.robot_length, CONFIG_SNAPSHOT.robot_width,
                                       "robot_rect_area", true);
 
-        visualizeRobotAreaTrajectory(_output.trajectory, angles, data.robot_area, "robot_area_trajectory", true, 0.1);
-        ROS_INFO_STREAM("Planner::visualize Done");
+        visualizeRobotAreaTrajectory(trajectory, angles, data.robot_area, "robot_area_trajectory", true, 0.1);
+        LOG_MARK("Planner::visualize Done");
     }
 
     void Planner::reset(State &state, RealTimeData &data, bool success)
     {
+        waitForSpeculation();
+        std::lock_guard<std::mutex> modules_lock(_modules_mutex);
+        if (_speculation && _speculation->result.valid())
+            _speculation->result.get(); // Prepared before the reset, not used
+        {
+            std::lock_guard<std::mutex> lock(_received_mutex);
+            _received_data.clear();
+        }
+
         _solver->reset(); // Reset the solver
 
         for (auto &module : _modules) // Reset modules
@@ -173,9 +671,35 @@ namespace MPCPlanner
 
     bool Planner::isObjectiveReached(const State &state, const RealTimeData &data) const
     {
+        waitForSpeculation();
+
         bool objective_reached = true;
         for (auto &module : _modules)
             objective_reached = objective_reached && module->isObjectiveReached(state, data);
         return objective_reached;
     }
+
+    void Planner::printSolverStatistics() const
+    {
+        _solver->getStatistics().print();
+        _scheduler->print();
+    }
+
+    void Planner::printModuleTimings() const
+    {
+        for (auto *timer : _update_timers)
+            timer->print();
+    }
+
+    void Planner::saveSolverStatistics(const std::string &file) const
+    {
+        std::ofstream out(file);
+        if (!out)
+        {
+            LOG_WARN("Could not open " << file << " to save the solver statistics");
+            return;
+        }
+        _solver->getStatistics().dump(out);
+        LOG_INFO("Saved solver statistics to " << file);
+    }
 }
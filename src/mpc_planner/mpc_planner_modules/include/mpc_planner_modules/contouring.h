@@ -14,7 +14,11 @@ namespace MPCPlanner
 
   public:
     void update(State &state, const RealTimeData &data, ModuleData &module_data) override;
+    unsigned int produces() const override { return ModuleData::PATH | ModuleData::CURRENT_PATH_SEGMENT | ModuleData::STATE | (_add_road_constraints ? ModuleData::STATIC_OBSTACLES : ModuleData::NONE); }
+    unsigned int consumes() const override { return ModuleData::NONE; }
+    std::vector<int> producedStates() const override { return {Layout::Var::SPLINE}; }
     void setParameters(const RealTimeData &data, const ModuleData &module_data, int k) override;
+    void setParametersRange(const RealTimeData &data, const ModuleData &module_data, int k_begin, int k_end) override;
 
     void onDataReceived(RealTimeData &data, std::string &&data_name) override;
     bool isDataReady(const RealTimeData &data, std::string &missing_data) override;
@@ -22,6 +26,7 @@ namespace MPCPlanner
     bool isObjectiveReached(const State &state, const RealTimeData &data) override;
 
     void visualize(const RealTimeData &data, const ModuleData &module_data) override;
+    bool snapshotVisuals() override;
 
     void reset() override;
 
@@ -32,14 +37,34 @@ namespace MPCPlanner
     int _closest_segment{0};
     int _n_segments;
 
+    double _road_width{0.}; // From the bounds of the last path that had them, otherwise road.width
+
     bool _add_road_constraints{false}, _two_way_road{false}, _dynamic_velocity_reference{false};
 
+    // Weights, read once per iteration in update()
+    double _contouring_weight{0.}, _lag_weight{0.}, _velocity_weight{0.}, _reference_velocity{0.};
+    double _terminal_angle_weight{0.}, _terminal_contouring_weight{0.};
+
+    // The spline parameters of each segment are consecutive: x (a, b, c, d), y (a, b, c, d), start
+    static constexpr int SPLINE_BLOCK_SIZE = 9;
+    std::vector<int> _spline_block_index;     // First parameter of each segment
+    std::vector<double> _spline_block_values; // Parameters of all segments, the same for all stages
+
     void constructRoadConstraints(const RealTimeData &data, ModuleData &module_data);
     void constructRoadConstraintsFromCenterline(const RealTimeData &data, ModuleData &module_data);
     void constructRoadConstraintsFromBounds(const RealTimeData &data, ModuleData &module_data);
 
+    virtual void readWeights();
+    virtual void setWeightParameters(int k);
+
+    void computeSplineParameters();
     void setSplineParameters(int k);
 
+    // Drawn by visualize() (see snapshotVisuals())
+    std::shared_ptr<RosTools::Spline2D> _visual_spline{nullptr};
+    int _visual_closest_segment{0};
+    std::vector<double> _visual_spline_progress; // Of the initial guess at each stage
+
     void visualizeReferencePath(const RealTimeData &data, const ModuleData &module_data);
     void visualizeCurrentSegment(const RealTimeData &data, const ModuleData &module_data);
     void visualizeTrackedSection(const RealTimeData &data, const ModuleData &module_data);
@@ -17,18 +17,32 @@ namespace MPCPlanner
 
   public:
     void update(State &state, const RealTimeData &data, ModuleData &module_data) override;
+    unsigned int produces() const override { return ModuleData::PATH_WIDTH; }
+    unsigned int consumes() const override { return ModuleData::CURRENT_PATH_SEGMENT; }
     void setParameters(const RealTimeData &data, const ModuleData &module_data, int k) override;
+    void setParametersRange(const RealTimeData &data, const ModuleData &module_data, int k_begin, int k_end) override;
 
     bool isDataReady(const RealTimeData &data, std::string &missing_data) override;
 
     void onDataReceived(RealTimeData &data, std::string &&data_name) override;
 
     void visualize(const RealTimeData &data, const ModuleData &module_data) override;
+    bool snapshotVisuals() override;
 
   private:
     int _num_segments;
 
     std::shared_ptr<tk::spline> _width_left{nullptr}, _width_right{nullptr};
+
+    // The width parameters of each segment are consecutive: right (a, b, c, d), left (a, b, c, d)
+    static constexpr int WIDTH_BLOCK_SIZE = 8;
+    std::vector<int> _width_block_index;
+    std::vector<double> _width_block_values;
+
+    std::vector<Eigen::Vector3d> _visual_outputs; // Planned x, y and spline progress of stages 1 ... N - 1
+
+    void computeWidthParameters(const ModuleData &module_data);
+    void setWidthParameters(int k);
   };
 }
 #endif // __ELLIPSOID_CONSTRAINTS_H_
@@ -8,6 +8,7 @@
 #include <ros_tools/logging.h>
 
 #include <memory>
+#include <vector>
 
 // To distinguish custom from regular optimization loops.
 #define EXIT_CODE_NOT_OPTIMIZED_YET -999
@@ -56,6 +57,17 @@ namespace MPCPlanner
             (void)module_data;
         };
 
+        /**
+         * @brief The ModuleData fields (ModuleData::Field flags) that update() writes and reads. The planner orders the
+         * updates by these declarations and runs updates without conflicts concurrently.
+         * @note The defaults order this module after all previous modules and before all later ones
+         */
+        virtual unsigned int produces() const { return ModuleData::ALL; }
+        virtual unsigned int consumes() const { return ModuleData::ALL; }
+
+        /** @brief The state variables (Layout::Var) that update() computes, for modules that produce ModuleData::STATE */
+        virtual std::vector<int> producedStates() const { return {}; }
+
         /** @brief Insert computed parameters for the solver */
         virtual void setParameters(const RealTimeData &data, const ModuleData &module_data, int k)
         {
@@ -64,6 +76,17 @@ namespace MPCPlanner
             (void)k;
         };
 
+        /**
+         * @brief Insert the parameters of stages [k_begin, k_end). Override to write values that are the same for all
+         * stages (computed once in update()) as blocks. The planner may call this concurrently for disjoint ranges, so it
+         * should only write the parameters of these stages and not modify the module
+         */
+        virtual void setParametersRange(const RealTimeData &data, const ModuleData &module_data, int k_begin, int k_end)
+        {
+            for (int k = k_begin; k < k_end; k++)
+                setParameters(data, module_data, k);
+        };
+
         /** @brief Visualize the computations in this module */
         virtual void visualize(const RealTimeData &data, const ModuleData &module_data)
         {
@@ -71,6 +94,15 @@ namespace MPCPlanner
             (void)module_data;
         };
 
+        /**
+         * @brief Copy the members (and solver outputs) that visualize() reads, called on the control thread before each
+         * visualize(). With asynchronous visualization, visualize() then runs on the visualization thread while the
+         * module is updated, it may only read these copies, data and module_data. The planner does not call this while
+         * visualize() runs.
+         * @return false if visualize() reads live members, the module is then drawn on the control thread
+         */
+        virtual bool snapshotVisuals() { return false; }
+
         /** ==== OPTIONAL FUNCTIONS ==== */
         /** @brief Check if the realtime data is complete for this module */
         virtual bool isDataReady(const RealTimeData &data, std::string &missing_data)
@@ -131,6 +163,8 @@ namespace MPCPlanner
     public:
         ModuleType type; /* Constraint or Objective type */
 
+        const std::string &getName() const { return _name; }
+
     protected:
         std::shared_ptr<Solver> _solver;
         std::string _name;
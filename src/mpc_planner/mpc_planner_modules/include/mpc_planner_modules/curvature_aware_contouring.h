@@ -12,10 +12,9 @@ namespace MPCPlanner
     public:
         CurvatureAwareContouring(std::shared_ptr<Solver> solver);
 
-    public:
-        void setParameters(const RealTimeData &data, const ModuleData &module_data, int k) override;
-
-    private:
+    protected:
+        void readWeights() override;
+        void setWeightParameters(int k) override;
     };
 }
 #endif // __CURVATURE_AWARE_CONTOURING_H_
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define __DECOMP_CONSTRAINTS_H_
 
 #include <mpc_planner_modules/controller_module.h>
+#include <mpc_planner_modules/occupied_cells.h>
 
 #include <decomp_util/ellipsoid_decomp.h>
 #include <decomp_util/decomp_geometry/geometric_utils.h>
@@ -17,26 +18,32 @@ namespace MPCPlanner
 
   public:
     void update(State &state, const RealTimeData &data, ModuleData &module_data) override;
+    unsigned int produces() const override { return ModuleData::NONE; }
+    unsigned int consumes() const override { return ModuleData::PATH | ModuleData::STATE; }
     void setParameters(const RealTimeData &data, const ModuleData &module_data, int k) override;
 
     bool isDataReady(const RealTimeData &data, std::string &missing_data) override;
 
     void visualize(const RealTimeData &data, const ModuleData &module_data) override;
+    bool snapshotVisuals() override;
 
   private:
     std::vector<std::vector<Eigen::ArrayXd>> _a1, _a2, _b; // Constraints [disc x step]
 
     std::unique_ptr<EllipsoidDecomp2D> _decomp_util;
-    vec_Vec2f _occ_pos;
+    OccupiedCells _occupied_cells; // Occupied positions of the costmap, updated incrementally
+    vec_Vec2f _path; // Reference path points at the predicted progress of each stage
     std::vector<LinearConstraint<2>> _constraints; // Static 2D halfspace constraints set in DecompUtil
     vec_E<Polyhedron<2>> _polyhedrons;
+    vec_E<Polyhedron<2>> _visual_polyhedrons; // Drawn by visualize() (see snapshotVisuals())
+    vec_Vec2f _visual_occupied_cells;         // Only with debug_visuals
     std::vector<std::unique_ptr<vec_Vec2f>> occ_pos_vec_stages_;
 
     double _dummy_a1{1.}, _dummy_a2{0.}, _dummy_b;
 
     int _n_discs;
 
-    DouglasRachford dr_projection_;
+    CircleProjection _projection;
 
     int _max_constraints;
 
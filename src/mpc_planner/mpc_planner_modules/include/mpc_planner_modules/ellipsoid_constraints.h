@@ -12,6 +12,8 @@ namespace MPCPlanner
 
   public:
     void update(State &state, const RealTimeData &data, ModuleData &module_data) override;
+    unsigned int produces() const override { return ModuleData::NONE; }
+    unsigned int consumes() const override { return ModuleData::NONE; }
     void setParameters(const RealTimeData &data, const ModuleData &module_data, int k) override;
 
     bool isDataReady(const RealTimeData &data, std::string &missing_data) override;
@@ -19,10 +21,13 @@ namespace MPCPlanner
     // void onDataReceived(RealTimeData &data, std::string &&data_name) override;
 
     void visualize(const RealTimeData &data, const ModuleData &module_data) override;
+    bool snapshotVisuals() override { return true; } // Draws nothing
 
   private:
     double _robot_radius, _risk;
+    double _chi; // Quantile of the risk, the same for all obstacles and stages
     int _n_discs;
+    unsigned int _max_obstacles;
 
     double _dummy_x{50.}, _dummy_y{50.};
   };
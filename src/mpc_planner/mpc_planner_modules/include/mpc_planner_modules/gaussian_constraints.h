@@ -12,14 +12,27 @@ namespace MPCPlanner
 
   public:
     void update(State &state, const RealTimeData &data, ModuleData &module_data) override;
+    unsigned int produces() const override { return ModuleData::NONE; }
+    unsigned int consumes() const override { return ModuleData::NONE; }
     void setParameters(const RealTimeData &data, const ModuleData &module_data, int k) override;
 
     bool isDataReady(const RealTimeData &data, std::string &missing_data) override;
 
     void visualize(const RealTimeData &data, const ModuleData &module_data) override;
+    bool snapshotVisuals() override;
 
   private:
     double _dummy_x{0.}, _dummy_y{0.};
+
+    // Read once per iteration in update()
+    double _robot_radius{0.}, _risk{0.}, _obstacle_radius{0.};
+    int _n_discs{1};
+
+    unsigned int _max_obstacles;
+
+    // Drawn by visualize() (see snapshotVisuals())
+    double _visual_risk{0.};
+    std::vector<double> _visual_prediction_times;
   };
 }
 #endif // __GAUSSIAN_CONSTRAINTS_H_
@@ -12,8 +12,11 @@ namespace MPCPlanner
 
   public:
     virtual void update(State &state, const RealTimeData &data, ModuleData &module_data) override;
+    unsigned int produces() const override { return ModuleData::NONE; }
+    unsigned int consumes() const override { return ModuleData::NONE; }
 
     virtual void setParameters(const RealTimeData &data, const ModuleData &module_data, int k) override;
+    virtual void setParametersRange(const RealTimeData &data, const ModuleData &module_data, int k_begin, int k_end) override;
 
     bool isObjectiveReached(const State &state, const RealTimeData &data) override;
 
@@ -21,8 +24,10 @@ namespace MPCPlanner
     bool isDataReady(const RealTimeData &data, std::string &missing_data) override;
 
     void visualize(const RealTimeData &data, const ModuleData &module_data) override;
+    bool snapshotVisuals() override { return true; } // Draws the data only
 
   private:
+    double _goal_weight{0.}; // Read once per iteration in update()
   };
 }
 
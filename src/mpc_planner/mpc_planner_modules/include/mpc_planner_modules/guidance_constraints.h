@@ -18,6 +18,7 @@
 
 #include <mpc_planner_modules/controller_module.h>
 #include <mpc_planner_solver/solver_interface.h>
+#include <mpc_planner_solver/solver_batch.h>
 
 #include <unordered_map>
 
@@ -60,6 +61,8 @@ namespace MPCPlanner
 
     public:
         void update(State &state, const RealTimeData &data, ModuleData &module_data) override;
+        unsigned int produces() const override { return ModuleData::NONE; }
+        unsigned int consumes() const override { return ModuleData::PATH | ModuleData::PATH_WIDTH | ModuleData::PATH_VELOCITY | ModuleData::STATIC_OBSTACLES | ModuleData::STATE; }
         void setParameters(const RealTimeData &data, const ModuleData &module_data, int k) override;
 
         bool isDataReady(const RealTimeData &data, std::string &missing_data) override;
@@ -97,7 +100,7 @@ namespace MPCPlanner
             bool taken = false;
             bool existing_guidance = false;
 
-            LocalPlanner(int _id, bool _is_original_planner = false);
+            LocalPlanner(int _id, std::shared_ptr<Solver> solver, bool _is_original_planner = false);
         };
 
         void setGoals(State &state, const ModuleData &module_data);
@@ -108,19 +111,28 @@ namespace MPCPlanner
 
     private: // Member variables
         std::vector<LocalPlanner> planners_;
+        std::vector<std::shared_ptr<Solver>> _batch_solvers; // The local solvers of planners_ (same order)
+        std::unique_ptr<SolverBatch> _solver_batch;
 
         std::shared_ptr<GuidancePlanner::GlobalGuidance> global_guidance_;
 
         std::unordered_map<int, int> _map_homotopy_class_to_planner;
 
         // Configuration parameters
-        bool _use_tmpcpp{true}, _enable_constraints{true};
+        bool _use_tmpcpp{true}, _enable_constraints{true}, _keep_solver_memory{true};
         double _control_frequency{20.};
-        double _planning_time;
 
         RealTimeData empty_data_;
 
         int best_planner_index_ = -1;
+
+        struct IterationStats
+        {
+            int solves{0};
+            long sqp_iterations{0};
+            long qp_iterations{0};
+        };
+        IterationStats _iteration_stats[2]; // Solver iterations when starting cold [0] or warm [1]
     };
 } // namespace MPCPlanner
 #endif // __GUIDANCE_CONSTRAINTS_H__
\ No newline at end of file
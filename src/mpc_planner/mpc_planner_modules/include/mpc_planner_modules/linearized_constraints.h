@@ -5,37 +5,61 @@
 
 #include <ros_tools/projection.h>
 
+#include <memory>
+
 namespace MPCPlanner
 {
+  class WorkerPool;
+
   class LinearizedConstraints : public ControllerModule
   {
   public:
     LinearizedConstraints(std::shared_ptr<Solver> solver);
+    ~LinearizedConstraints();
 
   public:
     void update(State &state, const RealTimeData &data, ModuleData &module_data) override;
+    unsigned int produces() const override { return ModuleData::NONE; }
+    unsigned int consumes() const override { return ModuleData::STATIC_OBSTACLES; }
     void setParameters(const RealTimeData &data, const ModuleData &module_data, int k) override;
 
     bool isDataReady(const RealTimeData &data, std::string &missing_data) override;
 
     void visualize(const RealTimeData &data, const ModuleData &module_data) override;
+    bool snapshotVisuals() override;
 
     void setTopologyConstraints();
 
   private:
     std::vector<std::vector<Eigen::ArrayXd>> _a1, _a2, _b; // Constraints [disc x step]
+    std::vector<Eigen::ArrayXd> _visual_a1, _visual_a2, _visual_b; // Of the first disc, drawn by visualize()
 
     double _dummy_a1{1.}, _dummy_a2{0.}, _dummy_b;
 
     bool _use_guidance{false};
     int _n_discs;
     int _n_other_halfspaces;
-
-    DouglasRachford dr_projection_;
+    double _robot_radius;
 
     int _num_obstacles, _max_obstacles;
 
-    void projectToSafety(const std::vector<DynamicObstacle> &copied_obstacles, int k, Eigen::Vector2d &pos);
+    // Obstacle predictions as structure of arrays [obstacle x step], a column holds all obstacles at one stage
+    Eigen::ArrayXXd _obstacle_x, _obstacle_y;
+    Eigen::ArrayXd _obstacle_radius; // Including the robot radius
+    double _cull_distance{0.};       // Obstacles further than this are not projected against
+
+    std::unique_ptr<WorkerPool> _stage_workers; // Each computes the halfspaces of a range of stages (if enabled)
+    std::vector<CircleProjection> _projections;  // One per range of stages
+
+    /** @brief Copy the obstacle predictions at the stage times into the SoA buffers */
+    void packObstacles(const std::vector<DynamicObstacle> &obstacles);
+
+    /** @brief Halfspaces of all discs and obstacles for stages [k_begin, k_end) */
+    void computeHalfspaces(const RealTimeData &data, const ModuleData &module_data, int k_begin, int k_end,
+                           CircleProjection &projection);
+
+    /** @brief Projects pos out of the obstacles at stage k */
+    void projectToSafety(int k, Eigen::Vector2d &pos, CircleProjection &projection) const;
   };
 } // namespace MPCPlanner
 #endif // __LINEARIZED_CONSTRAINTS_H_
@@ -24,11 +24,18 @@ namespace MPCPlanner
 
   public:
     virtual void update(State &state, const RealTimeData &data, ModuleData &module_data) override;
+    unsigned int produces() const override { return ModuleData::NONE; }
+    unsigned int consumes() const override { return ModuleData::NONE; }
 
     virtual void setParameters(const RealTimeData &data, const ModuleData &module_data, int k) override;
+    virtual void setParametersRange(const RealTimeData &data, const ModuleData &module_data, int k_begin, int k_end) override;
 
   private:
     std::vector<std::string> _weight_names;
+    std::vector<int> _weight_indices;   // Index of each weight in the solver parameters (Layout::Param)
+    std::vector<int> _config_indices;   // Index of each weight in the configuration snapshot
+    std::vector<double> _weight_values; // Weights read from the configuration in update()
+    bool _weights_consecutive{false};   // The weights can be written as one block
   };
 }
 
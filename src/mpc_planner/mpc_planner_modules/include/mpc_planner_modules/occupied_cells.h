@@ -0,0 +1,70 @@
+#ifndef __OCCUPIED_CELLS_H_
+#define __OCCUPIED_CELLS_H_
+
+#include <decomp_util/decomp_basis/data_type.h>
+
+#include <vector>
+
+namespace costmap_2d
+{
+  class Costmap2D;
+}
+
+namespace MPCPlanner
+{
+  /**
+   * @brief The occupied (not free) cells of a costmap as world positions, kept between updates. Each update compares
+   * the costs with a copy of the previous costs and only adds or removes the cells that changed. When a rolling window
+   * moved, the copy and the cells are shifted along, the map is only read again from scratch when its size or
+   * resolution changed.
+   *
+   * The positions are the same as those of a full scan over x and then y (cell centers, in the order of the scan), so
+   * that the decomposition and the first position (the projection anchor) do not depend on the update history.
+   */
+  class OccupiedCells
+  {
+  public:
+    /** @brief Work done by the last update */
+    struct Statistics
+    {
+      bool rebuilt{false};   // The whole map was read (first update, size or resolution changed, or moved too far)
+      int shift_x{0};        // Cells that the window moved
+      int shift_y{0};
+      int changed_rows{0};   // Rows of which the costs were compared cell by cell
+      int changed_cells{0};  // Cells that became occupied or free
+      int occupied_cells{0}; // After the update
+    };
+
+  public:
+    void update(const costmap_2d::Costmap2D &costmap);
+
+    /** @brief Positions of the occupied cells, in the order of a scan over x and then y */
+    const vec_Vec2f &getPositions() const { return _positions; }
+
+    const Statistics &getStatistics() const { return _statistics; }
+
+  private:
+    unsigned int _size_x{0}, _size_y{0};
+    double _resolution{0.};
+    double _origin_x{0.}, _origin_y{0.};
+
+    std::vector<unsigned char> _costs, _shifted_costs; // Costs at the last update
+    std::vector<unsigned int> _point_cell;             // Cell of each position in scan order (i * size_y + j), sorted
+    std::vector<unsigned int> _added, _removed;        // Cells that changed in this update, in scan order
+
+    vec_Vec2f _positions;
+    vec_Vec2f _merged_positions; // Memory for the merge, kept between updates
+    std::vector<unsigned int> _merged_point_cell;
+
+    Statistics _statistics;
+
+    void rebuild(const costmap_2d::Costmap2D &costmap);
+    void shift(int shift_x, int shift_y);
+
+    /** @brief Remove the freed cells from and merge the new cells into the sorted positions */
+    void merge();
+
+    Vec2f cellCenter(unsigned int cell) const;
+  };
+} // namespace MPCPlanner
+#endif // __OCCUPIED_CELLS_H_
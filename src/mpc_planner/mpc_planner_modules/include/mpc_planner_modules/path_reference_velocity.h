@@ -28,16 +28,31 @@ namespace MPCPlanner
 
   public:
     virtual void update(State &state, const RealTimeData &data, ModuleData &module_data) override;
+    unsigned int produces() const override { return ModuleData::PATH_VELOCITY; }
+    unsigned int consumes() const override { return ModuleData::CURRENT_PATH_SEGMENT; }
 
     virtual void onDataReceived(RealTimeData &data, std::string &&data_name) override;
 
     virtual void setParameters(const RealTimeData &data, const ModuleData &module_data, int k) override;
+    virtual void setParametersRange(const RealTimeData &data, const ModuleData &module_data, int k_begin, int k_end) override;
 
     virtual void visualize(const RealTimeData &data, const ModuleData &module_data) override;
+    bool snapshotVisuals() override;
 
   private:
     std::shared_ptr<tk::spline> _velocity_spline;
+    std::shared_ptr<tk::spline> _visual_velocity_spline; // Drawn by visualize(), replaced (not modified) on a new path
     int _n_segments;
+
+    double _reference_velocity{0.}; // Read once per iteration in update()
+
+    // The velocity spline parameters of each segment are consecutive: a, b, c, d
+    static constexpr int VELOCITY_BLOCK_SIZE = 4;
+    std::vector<int> _velocity_block_index;
+    std::vector<double> _velocity_block_values;
+
+    void computeVelocityParameters(const RealTimeData &data, const ModuleData &module_data);
+    void setVelocityParameters(int k);
   };
 }
 
@@ -3,6 +3,8 @@
 
 #include <mpc_planner_modules/controller_module.h>
 
+#include <mpc_planner_solver/solver_batch.h>
+
 #include <scenario_module/scenario_module.h>
 
 namespace MPCPlanner
@@ -26,8 +28,6 @@ namespace MPCPlanner
     void visualize(const RealTimeData &data, const ModuleData &module_data) override;
 
   private:
-    double _planning_time;
-
     /** @brief a struct to collect parallel scenario optimizations */
     struct ScenarioSolver
     {
@@ -39,9 +39,11 @@ namespace MPCPlanner
       ScenarioModule::ScenarioStatus status{ScenarioModule::ScenarioStatus::SUCCESS};
       ScenarioModule::SupportSubsample support;
 
-      ScenarioSolver(int id);
+      ScenarioSolver(std::shared_ptr<Solver> scenario_solver);
     };
     std::vector<std::unique_ptr<ScenarioSolver>> _scenario_solvers;
+    std::vector<std::shared_ptr<Solver>> _batch_solvers; // The solvers of _scenario_solvers (same order)
+    std::unique_ptr<SolverBatch> _solver_batch;
 
     ScenarioSolver *_best_solver;
 
@@ -0,0 +1,121 @@
+/**
+ * @file static_modules.h
+ * @brief Module loops with the module types known at compile time. The solver generator emits
+ * `using GeneratedModules = StaticModules<...>` in modules.h when solver_settings.static_modules is enabled.
+ */
+#ifndef __MPC_PLANNER_STATIC_MODULES_H__
+#define __MPC_PLANNER_STATIC_MODULES_H__
+
+#include <mpc_planner_modules/controller_module.h>
+
+#include <mpc_planner_solver/mpc_planner_layout.h>
+
+#include <ros_tools/logging.h>
+#include <ros_tools/profiling.h>
+
+#include <array>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace MPCPlanner
+{
+    /** @brief The module loops of one planner iteration (update, then set the parameters of all stages) */
+    class ModuleDispatch
+    {
+    public:
+        virtual ~ModuleDispatch() = default;
+
+        virtual void update(State &state, const RealTimeData &data, ModuleData &module_data) = 0;
+        virtual void setParameters(const RealTimeData &data, const ModuleData &module_data) = 0;
+    };
+
+    /**
+     * @brief Calls the modules through their concrete types, in order, so that the calls are not virtual and the stage
+     * loops have a compile-time length (Layout::N). Refers to the modules of the dynamic module vector.
+     */
+    template <class... Modules>
+    class StaticModules : public ModuleDispatch
+    {
+    public:
+        /**
+         * @param modules The modules created by initializeModules(), in the same order as Modules
+         * @param update_timers Optional, times the update of each module (same order)
+         */
+        StaticModules(const std::vector<std::shared_ptr<ControllerModule>> &modules,
+                      const std::vector<RosTools::Benchmarker *> &update_timers = {})
+            : StaticModules(modules, std::index_sequence_for<Modules...>{})
+        {
+            _update_timers.fill(nullptr);
+            for (size_t i = 0; i < update_timers.size() && i < _update_timers.size(); i++)
+                _update_timers[i] = update_timers[i];
+        }
+
+        void update(State &state, const RealTimeData &data, ModuleData &module_data) override
+        {
+            update(state, data, module_data, std::index_sequence_for<Modules...>{});
+        }
+
+        void setParameters(const RealTimeData &data, const ModuleData &module_data) override
+        {
+            std::apply([&](auto &...module)
+                       { (setModuleParameters(*module, data, module_data), ...); },
+                       _modules);
+        }
+
+    private:
+        std::tuple<std::shared_ptr<Modules>...> _modules;
+        std::array<RosTools::Benchmarker *, sizeof...(Modules)> _update_timers;
+
+        template <std::size_t... I>
+        StaticModules(const std::vector<std::shared_ptr<ControllerModule>> &modules, std::index_sequence<I...>)
+            : _modules(std::dynamic_pointer_cast<Modules>(modules.at(I))...)
+        {
+            ROSTOOLS_ASSERT(modules.size() == sizeof...(Modules), "The static module set does not match the created modules");
+            ROSTOOLS_ASSERT((std::get<I>(_modules) && ...), "The static module set does not match the created modules");
+        }
+
+        // Modules that do not override setParametersRange() get the per-stage loop here, where it can be inlined
+        template <class Module>
+        static constexpr bool overridesRange()
+        {
+            using BaseRange = void (ControllerModule::*)(const RealTimeData &, const ModuleData &, int, int);
+            return !std::is_same_v<decltype(&Module::setParametersRange), BaseRange>;
+        }
+
+        template <std::size_t... I>
+        void update(State &state, const RealTimeData &data, ModuleData &module_data, std::index_sequence<I...>)
+        {
+            (updateModule(*std::get<I>(_modules), _update_timers[I], state, data, module_data), ...);
+        }
+
+        // Qualified calls are not dispatched through the vtable
+        template <class Module>
+        static void updateModule(Module &module, RosTools::Benchmarker *timer, State &state, const RealTimeData &data,
+                                 ModuleData &module_data)
+        {
+            if (timer)
+                timer->start();
+            module.Module::update(state, data, module_data);
+            if (timer)
+                timer->stop();
+        }
+
+        template <class Module>
+        static void setModuleParameters(Module &module, const RealTimeData &data, const ModuleData &module_data)
+        {
+            if constexpr (overridesRange<Module>())
+            {
+                module.Module::setParametersRange(data, module_data, 0, Layout::N);
+            }
+            else
+            {
+                for (int k = 0; k < Layout::N; k++)
+                    module.Module::setParameters(data, module_data, k);
+            }
+        }
+    };
+}
+#endif // __MPC_PLANNER_STATIC_MODULES_H__
@@ -23,6 +23,7 @@ class DecompConstraintModule(ConstraintModule):
         self.import_name = "decomp_constraints.h"
 
         self.dependencies.append("decomp_util")
+        self.sources.append("occupied_cells.cpp")  # Incremental extraction of the occupied costmap cells
 
         self.constraints.append(
             LinearConstraints(n_discs=settings["n_discs"], max_constraints=settings["decomp"]["max_constraints"], use_slack=True)
@@ -21,6 +21,16 @@ namespace MPCPlanner
     _add_road_constraints = CONFIG["contouring"]["add_road_constraints"].as<bool>();
     _two_way_road = CONFIG["road"]["two_way"].as<bool>();
     _dynamic_velocity_reference = CONFIG["contouring"]["dynamic_velocity_reference"].as<bool>();
+    _road_width = CONFIG_SNAPSHOT.road_width;
+
+    _spline_block_values.resize(_n_segments * SPLINE_BLOCK_SIZE);
+    for (int i = 0; i < _n_segments; i++)
+    {
+      std::string segment = std::to_string(i);
+      _spline_block_index.push_back(Layout::paramIndex("spline_x" + segment + "_a"));
+      ROSTOOLS_ASSERT(Layout::paramIndex("spline" + segment + "_start") == _spline_block_index.back() + SPLINE_BLOCK_SIZE - 1,
+                      "The spline parameters of a segment should be consecutive in the generated solver");
+    }
 
     LOG_INITIALIZED();
   }
@@ -39,13 +49,34 @@ namespace MPCPlanner
     if (module_data.path.get() == nullptr && _spline.get() != nullptr)
       module_data.path = _spline;
 
-    state.set("spline", closest_s); // We need to initialize the spline state here
-    state.print();
+    state.set(Layout::Var::SPLINE, closest_s); // We need to initialize the spline state here
+    if (CONFIG_SNAPSHOT.debug_output)
+      state.print();
 
     module_data.current_path_segment = _closest_segment;
+    module_data.road_width = _road_width;
 
     if (_add_road_constraints)
       constructRoadConstraints(data, module_data);
+
+    readWeights();
+    computeSplineParameters(); // The path segments are the same for all stages
+  }
+
+  void Contouring::readWeights()
+  {
+    const ConfigSnapshot &config = CONFIG_SNAPSHOT;
+    _contouring_weight = config.weight("contour");
+    _lag_weight = config.weight("lag");
+
+    _terminal_angle_weight = config.weight("terminal_angle");
+    _terminal_contouring_weight = config.weight("terminal_contouring");
+
+    if (_dynamic_velocity_reference)
+    {
+      _reference_velocity = config.weight("reference_velocity");
+      _velocity_weight = config.weight("velocity");
+    }
   }
 
   void Contouring::setParameters(const RealTimeData &data, const ModuleData &module_data, int k)
@@ -53,77 +84,59 @@ namespace MPCPlanner
     (void)data;
     (void)module_data;
 
-    // Retrieve weights once
-    static double contouring_weight, lag_weight, reference_velocity, velocity_weight;
-    static double terminal_angle_weight, terminal_contouring_weight;
-    if (k == 0)
-    {
-      contouring_weight = CONFIG["weights"]["contour"].as<double>();
-      lag_weight = CONFIG["weights"]["lag"].as<double>();
+    setWeightParameters(k);
+    setSplineParameters(k);
+  }
 
-      terminal_angle_weight = CONFIG["weights"]["terminal_angle"].as<double>();
-      terminal_contouring_weight = CONFIG["weights"]["terminal_contouring"].as<double>();
+  void Contouring::setParametersRange(const RealTimeData &data, const ModuleData &module_data, int k_begin, int k_end)
+  {
+    (void)data;
+    (void)module_data;
 
-      if (_dynamic_velocity_reference)
-      {
-        reference_velocity = CONFIG["weights"]["reference_velocity"].as<double>();
-        velocity_weight = CONFIG["weights"]["velocity"].as<double>();
-      }
-      else
-      {
-        (void)velocity_weight;
-      }
+    for (int k = k_begin; k < k_end; k++)
+    {
+      setWeightParameters(k);
+      setSplineParameters(k);
     }
+  }
 
-    {
-      setSolverParameterContour(k, _solver->_params, contouring_weight);
-      setSolverParameterLag(k, _solver->_params, lag_weight);
+  void Contouring::setWeightParameters(int k)
+  {
+    setSolverParameterContour(k, _solver->_params, _contouring_weight);
+    setSolverParameterLag(k, _solver->_params, _lag_weight);
 
-      setSolverParameterTerminalAngle(k, _solver->_params, terminal_angle_weight);
-      setSolverParameterTerminalContouring(k, _solver->_params, terminal_contouring_weight);
+    setSolverParameterTerminalAngle(k, _solver->_params, _terminal_angle_weight);
+    setSolverParameterTerminalContouring(k, _solver->_params, _terminal_contouring_weight);
 
-      if (_dynamic_velocity_reference)
-      {
-        setSolverParameterVelocity(k, _solver->_params, velocity_weight);
-        setSolverParameterReferenceVelocity(k, _solver->_params, reference_velocity);
-      }
+    if (_dynamic_velocity_reference)
+    {
+      setSolverParameterVelocity(k, _solver->_params, _velocity_weight);
+      setSolverParameterReferenceVelocity(k, _solver->_params, _reference_velocity);
     }
-
-    setSplineParameters(k);
   }
 
-  void Contouring::setSplineParameters(int k)
+  void Contouring::computeSplineParameters()
   {
-    double ax, bx, cx, dx;
-    double ay, by, cy, dy;
-    double start;
-
     for (int i = 0; i < _n_segments; i++)
     {
       int index = _closest_segment + i;
+      double *block = &_spline_block_values[i * SPLINE_BLOCK_SIZE];
 
       _spline->getParameters(index,
-                             ax, bx, cx, dx,
-                             ay, by, cy, dy);
-
-      start = _spline->getSegmentStart(index);
-
-      /** @note: We use the fast loading interface here as we need to load many parameters */
-      setSolverParameterSplineXA(k, _solver->_params, ax, i);
-      setSolverParameterSplineXB(k, _solver->_params, bx, i);
-      setSolverParameterSplineXC(k, _solver->_params, cx, i);
-      setSolverParameterSplineXD(k, _solver->_params, dx, i);
-
-      setSolverParameterSplineYA(k, _solver->_params, ay, i);
-      setSolverParameterSplineYB(k, _solver->_params, by, i);
-      setSolverParameterSplineYC(k, _solver->_params, cy, i);
-      setSolverParameterSplineYD(k, _solver->_params, dy, i);
+                             block[0], block[1], block[2], block[3],
+                             block[4], block[5], block[6], block[7]);
 
       // Distance where this spline starts
-      setSolverParameterSplineStart(k, _solver->_params, start, i);
+      block[8] = _spline->getSegmentStart(index);
     }
   }
 
+  void Contouring::setSplineParameters(int k)
+  {
+    for (int i = 0; i < _n_segments; i++)
+      _solver->setParameterBlock(k, _spline_block_index[i], &_spline_block_values[i * SPLINE_BLOCK_SIZE], SPLINE_BLOCK_SIZE);
+  }
+
   void Contouring::onDataReceived(RealTimeData &data, std::string &&data_name)
   {
     if (data_name == "reference_path")
@@ -149,8 +162,8 @@ namespace MPCPlanner
             data.right_bound.y,
             _spline->getTVector());
 
-        // Update the road width
-        CONFIG["road"]["width"] = RosTools::distance(_bound_left->getPoint(0), _bound_right->getPoint(0));
+        // Update the road width (shared with other modules through the module data)
+        _road_width = RosTools::distance(_bound_left->getPoint(0), _bound_right->getPoint(0));
       }
 
       _closest_segment = -1;
@@ -201,12 +214,12 @@ namespace MPCPlanner
 
     // OLD VERSION:
     bool two_way = _two_way_road;
-    double road_width_half = CONFIG["road"]["width"].as<double>() / 2.;
+    double road_width_half = _road_width / 2.;
     for (int k = 1; k < _solver->N; k++)
     {
       module_data.static_obstacles[k].clear();
 
-      double cur_s = _solver->getEgoPrediction(k, "spline");
+      double cur_s = _solver->getEgoPrediction(k, Layout::Var::SPLINE);
 
       // This is the final point and the normal vector of the path
       Eigen::Vector2d path_point = _spline->getPoint(cur_s);
@@ -248,7 +261,7 @@ namespace MPCPlanner
     for (int k = 1; k < _solver->N; k++)
     {
       module_data.static_obstacles[k].clear();
-      double cur_s = _solver->getEgoPrediction(k, "spline");
+      double cur_s = _solver->getEgoPrediction(k, Layout::Var::SPLINE);
 
       // Left
       Eigen::Vector2d Al = _bound_left->getOrthogonal(cur_s);
@@ -262,9 +275,20 @@ namespace MPCPlanner
     }
   }
 
+  bool Contouring::snapshotVisuals()
+  {
+    _visual_spline = _spline; // Replaced, not modified, when a new path arrives
+    _visual_closest_segment = _closest_segment;
+
+    _visual_spline_progress.resize(_solver->N);
+    for (int k = 0; k < _solver->N; k++)
+      _visual_spline_progress[k] = _solver->getEgoPrediction(k, Layout::Var::SPLINE);
+    return true;
+  }
+
   void Contouring::visualize(const RealTimeData &data, const ModuleData &module_data)
   {
-    if (_spline.get() == nullptr)
+    if (_visual_spline.get() == nullptr)
       return;
 
     if (data.reference_path.empty())
@@ -276,7 +300,7 @@ namespace MPCPlanner
     visualizeReferencePath(data, module_data);
     visualizeRoadConstraints(data, module_data);
 
-    if (CONFIG["debug_visuals"].as<bool>())
+    if (CONFIG_SNAPSHOT.debug_visuals)
     {
       visualizeCurrentSegment(data, module_data);
       visualizeDebugRoadBoundary(data, module_data);
@@ -296,7 +320,7 @@ namespace MPCPlanner
     auto &cur_point = publisher_current.getNewPointMarker("CUBE");
     cur_point.setColorInt(10);
     cur_point.setScale(0.3, 0.3, 0.3);
-    cur_point.addPointMarker(_spline->getPoint(_spline->getSegmentStart(_closest_segment)), 0.0);
+    cur_point.addPointMarker(_visual_spline->getPoint(_visual_spline->getSegmentStart(_visual_closest_segment)), 0.0);
     publisher_current.publish();
   }
 
@@ -313,13 +337,13 @@ namespace MPCPlanner
     line.setScale(0.3, 0.3, 0.3);
 
     /** @todo visualize each section*/
-    for (int i = _closest_segment; i < _closest_segment + _n_segments; i++)
+    for (int i = _visual_closest_segment; i < _visual_closest_segment + _n_segments; i++)
     {
-      double s_start = _spline->getSegmentStart(i);
-      for (double s = s_start + 1.0; s < _spline->getSegmentStart(i + 1); s += 1.0)
+      double s_start = _visual_spline->getSegmentStart(i);
+      for (double s = s_start + 1.0; s < _visual_spline->getSegmentStart(i + 1); s += 1.0)
       {
         if (s > 0)
-          line.addLine(_spline->getPoint(s - 1.0), _spline->getPoint(s));
+          line.addLine(_visual_spline->getPoint(s - 1.0), _visual_spline->getPoint(s));
       }
     }
 
@@ -332,7 +356,7 @@ namespace MPCPlanner
     (void)module_data;
 
     visualizePathPoints(data.reference_path, _name + "/path", false);
-    visualizeSpline(*_spline, _name + "/path", true);
+    visualizeSpline(*_visual_spline, _name + "/path", true);
   }
 
   void Contouring::visualizeRoadConstraints(const RealTimeData &data, const ModuleData &module_data)
@@ -356,24 +380,23 @@ namespace MPCPlanner
 
   void Contouring::visualizeDebugRoadBoundary(const RealTimeData &data, const ModuleData &module_data)
   {
-    (void)module_data;
     auto &publisher = VISUALS.getPublisher(_name + "/road_boundary_points");
     auto &points = publisher.getNewPointMarker("CUBE");
     points.setScale(0.15, 0.15, 0.15);
 
     // OLD VERSION:
     bool two_way = _two_way_road;
-    double road_width_half = CONFIG["road"]["width"].as<double>() / 2.;
+    double road_width_half = module_data.road_width / 2.;
     for (int k = 1; k < _solver->N; k++)
     {
 
-      double cur_s = _solver->getEgoPrediction(k, "spline");
-      Eigen::Vector2d path_point = _spline->getPoint(cur_s);
+      double cur_s = _visual_spline_progress[k];
+      Eigen::Vector2d path_point = _visual_spline->getPoint(cur_s);
 
       points.setColorInt(5, 10);
       points.addPointMarker(path_point);
 
-      Eigen::Vector2d dpath = _spline->getOrthogonal(cur_s);
+      Eigen::Vector2d dpath = _visual_spline->getOrthogonal(cur_s);
 
       double width_times = two_way ? 3.0 : 1.0; // 3w for double lane
 
@@ -408,27 +431,27 @@ namespace MPCPlanner
 
       for (int i = 0; i < _n_segments; i++)
       {
-        int index = _closest_segment + i;
+        int index = _visual_closest_segment + i;
         double ax, bx, cx, dx;
         double ay, by, cy, dy;
         double start;
 
-        if (index < _spline->numSegments())
+        if (index < _visual_spline->numSegments())
         {
-          _spline->getParameters(index,
+          _visual_spline->getParameters(index,
                                  ax, bx, cx, dx,
                                  ay, by, cy, dy);
 
-          start = _spline->getSegmentStart(index);
+          start = _visual_spline->getSegmentStart(index);
         }
         else
         {
           // If we are beyond the spline, we should use the last spline
-          _spline->getParameters(_spline->numSegments() - 1,
+          _visual_spline->getParameters(_visual_spline->numSegments() - 1,
                                  ax, bx, cx, dx,
                                  ay, by, cy, dy);
 
-          start = _spline->getSegmentStart(_spline->numSegments() - 1);
+          start = _visual_spline->getSegmentStart(_visual_spline->numSegments() - 1);
 
           // We should use very small splines at the end location
           // x = d_x
@@ -439,10 +462,10 @@ namespace MPCPlanner
           ay = 0.;
           by = 0.;
           cy = 0.;
-          start = _spline->parameterLength();
+          start = _visual_spline->parameterLength();
         }
 
-        double s = _solver->getEgoPrediction(k, "spline") - start;
+        double s = _visual_spline_progress[k] - start;
         path_x.push_back(ax * s * s * s + bx * s * s + cx * s + dx);
         path_y.push_back(ay * s * s * s + by * s * s + cy * s + dy);
 
@@ -479,8 +502,8 @@ namespace MPCPlanner
 
     for (int k = 0; k < _solver->N; k++)
     {
-      double cur_s = _solver->getEgoPrediction(k, "spline");
-      Eigen::Vector2d path_point = _spline->getPoint(cur_s);
+      double cur_s = _visual_spline_progress[k];
+      Eigen::Vector2d path_point = _visual_spline->getPoint(cur_s);
       points.addPointMarker(path_point);
     }
 
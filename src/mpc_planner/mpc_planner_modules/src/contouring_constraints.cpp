@@ -8,6 +8,8 @@
 #include <ros_tools/spline.h>
 #include <ros_tools/math.h>
 
+#include <algorithm>
+
 namespace MPCPlanner
 {
   ContouringConstraints::ContouringConstraints(std::shared_ptr<Solver> solver)
@@ -17,6 +19,15 @@ namespace MPCPlanner
     LOG_INITIALIZED();
 
     _num_segments = CONFIG["contouring"]["num_segments"].as<int>();
+
+    _width_block_values.resize(_num_segments * WIDTH_BLOCK_SIZE);
+    for (int i = 0; i < _num_segments; i++)
+    {
+      std::string segment = std::to_string(i);
+      _width_block_index.push_back(Layout::paramIndex("width_right" + segment + "_a"));
+      ROSTOOLS_ASSERT(Layout::paramIndex("width_left" + segment + "_d") == _width_block_index.back() + WIDTH_BLOCK_SIZE - 1,
+                      "The width parameters of a segment should be consecutive in the generated solver");
+    }
   }
 
   void ContouringConstraints::update(State &state, const RealTimeData &data, ModuleData &module_data)
@@ -29,6 +40,8 @@ namespace MPCPlanner
 
     if (module_data.path_width_right == nullptr && _width_right != nullptr)
       module_data.path_width_right = _width_right;
+
+    computeWidthParameters(module_data); // The path segments are the same for all stages
   }
 
   void ContouringConstraints::onDataReceived(RealTimeData &data, std::string &&data_name)
@@ -71,52 +84,54 @@ namespace MPCPlanner
 
   void ContouringConstraints::setParameters(const RealTimeData &data, const ModuleData &module_data, int k)
   {
+    (void)data;
+    (void)module_data;
+
+    setWidthParameters(k);
+  }
+
+  void ContouringConstraints::setParametersRange(const RealTimeData &data, const ModuleData &module_data, int k_begin, int k_end)
+  {
+    (void)data;
     (void)module_data;
 
-    if (k == 1)
-      LOG_MARK("ContouringConstraints::setParameters");
+    if (k_begin <= 1 && 1 < k_end)
+      LOG_MARK("ContouringConstraints::setParametersRange");
+
+    for (int k = k_begin; k < k_end; k++)
+      setWidthParameters(k);
+  }
 
+  void ContouringConstraints::computeWidthParameters(const ModuleData &module_data)
+  {
     for (int i = 0; i < _num_segments; i++)
     {
       int index = module_data.current_path_segment + i;
+      double *right = &_width_block_values[i * WIDTH_BLOCK_SIZE];
+      double *left = right + WIDTH_BLOCK_SIZE / 2;
 
       // Boundaries
-      double ra, rb, rc, rd;
-      double la, lb, lc, ld;
-
       if (index < _width_right->m_x_.size() - 1)
       {
-
-        _width_right->getParameters(index, ra, rb, rc, rd);
-        _width_left->getParameters(index, la, lb, lc, ld);
+        _width_right->getParameters(index, right[0], right[1], right[2], right[3]);
+        _width_left->getParameters(index, left[0], left[1], left[2], left[3]);
       }
       else
       {
-        _width_right->getParameters(_width_right->m_x_.size() - 1, ra, rb, rc, rd);
-        _width_left->getParameters(_width_left->m_x_.size() - 1, la, lb, lc, ld);
-
-        ra = 0.;
-        rb = 0.;
-        rc = 0.;
-        la = 0.;
-        lb = 0.;
-        lc = 0.;
-      }
-
-      // Boundary
-      setSolverParameterWidthRightA(k, _solver->_params, ra, i);
-      setSolverParameterWidthRightB(k, _solver->_params, rb, i);
-      setSolverParameterWidthRightC(k, _solver->_params, rc, i);
-      setSolverParameterWidthRightD(k, _solver->_params, rd, i);
+        _width_right->getParameters(_width_right->m_x_.size() - 1, right[0], right[1], right[2], right[3]);
+        _width_left->getParameters(_width_left->m_x_.size() - 1, left[0], left[1], left[2], left[3]);
 
-      setSolverParameterWidthLeftA(k, _solver->_params, la, i);
-      setSolverParameterWidthLeftB(k, _solver->_params, lb, i);
-      setSolverParameterWidthLeftC(k, _solver->_params, lc, i);
-      setSolverParameterWidthLeftD(k, _solver->_params, ld, i);
+        // Constant width at the end
+        std::fill_n(right, 3, 0.);
+        std::fill_n(left, 3, 0.);
+      }
     }
+  }
 
-    if (k == 1)
-      LOG_MARK("ContouringConstraints::setParameters Done");
+  void ContouringConstraints::setWidthParameters(int k)
+  {
+    for (int i = 0; i < _num_segments; i++)
+      _solver->setParameterBlock(k, _width_block_index[i], &_width_block_values[i * WIDTH_BLOCK_SIZE], WIDTH_BLOCK_SIZE);
   }
 
   bool ContouringConstraints::isDataReady(const RealTimeData &data, std::string &missing_data)
@@ -130,19 +145,34 @@ namespace MPCPlanner
     return true;
   }
 
+  bool ContouringConstraints::snapshotVisuals()
+  {
+    _visual_outputs.resize(_solver->N - 1);
+    for (int k = 1; k < _solver->N; k++)
+    {
+      _visual_outputs[k - 1] = Eigen::Vector3d(_solver->getOutput(k, Layout::Var::X), _solver->getOutput(k, Layout::Var::Y),
+                                               _solver->getOutput(k, Layout::Var::SPLINE));
+    }
+    return true;
+  }
+
   void ContouringConstraints::visualize(const RealTimeData &data, const ModuleData &module_data)
   {
     (void)data;
     (void)module_data;
 
-    if (!CONFIG["debug_visuals"].as<bool>())
+    if (!CONFIG_SNAPSHOT.debug_visuals)
       return;
 
     LOG_MARK("ContouringConstraints::Visualize");
 
-    if (_width_right == nullptr || _width_left == nullptr || module_data.path == nullptr)
+    if (module_data.path_width_right == nullptr || module_data.path_width_left == nullptr || module_data.path == nullptr)
       return;
 
+    // The widths in the module data are replaced, not modified, when a new path arrives
+    const tk::spline &width_left = *module_data.path_width_left;
+    const tk::spline &width_right = *module_data.path_width_right;
+
     auto &line_publisher = VISUALS.getPublisher(_name + "/road_boundary");
     auto &line = line_publisher.getNewLine();
     line.setScale(0.1);
@@ -150,10 +180,10 @@ namespace MPCPlanner
 
     Eigen::Vector2d prev_right, prev_left;
 
-    for (double cur_s = 0.; cur_s < _width_right->m_x_.back(); cur_s += 0.5)
+    for (double cur_s = 0.; cur_s < width_right.m_x_.back(); cur_s += 0.5)
     {
-      double right = _width_right->operator()(cur_s);
-      double left = _width_left->operator()(cur_s);
+      double right = width_right(cur_s);
+      double left = width_left(cur_s);
 
       Eigen::Vector2d path_point = module_data.path->getPoint(cur_s);
       Eigen::Vector2d dpath = module_data.path->getOrthogonal(cur_s);
@@ -181,7 +211,7 @@ namespace MPCPlanner
     for (int k = 1; k < _solver->N; k++)
     {
 
-      double cur_s = _solver->getOutput(k, "spline");
+      double cur_s = _visual_outputs[k - 1](2);
       Eigen::Vector2d path_point = module_data.path->getPoint(cur_s);
 
       points.setColorInt(5, 10);
@@ -190,19 +220,19 @@ namespace MPCPlanner
       Eigen::Vector2d dpath = module_data.path->getOrthogonal(cur_s);
 
       // line is parallel to the spline
-      Eigen::Vector2d boundary_left = path_point - dpath * (_width_left->operator()(cur_s));
-      Eigen::Vector2d boundary_right = path_point + dpath * (_width_right->operator()(cur_s));
+      Eigen::Vector2d boundary_left = path_point - dpath * (width_left(cur_s));
+      Eigen::Vector2d boundary_right = path_point + dpath * (width_right(cur_s));
 
       // Visualize the contouring error
-      double w_cur = CONFIG["robot"]["width"].as<double>() / 2.;
-      Eigen::Vector2d pos(_solver->getOutput(k, "x"), _solver->getOutput(k, "y"));
+      double w_cur = CONFIG_SNAPSHOT.robot_width / 2.;
+      Eigen::Vector2d pos = _visual_outputs[k - 1].head<2>();
 
       points.setColor(0., 0., 0.);
       points.addPointMarker(pos, 0.2); // Planned positions and black dots
 
       double contour_error = dpath.transpose() * (pos - path_point);
-      double w_right = _width_right->operator()(cur_s);
-      double w_left = _width_left->operator()(cur_s);
+      double w_right = width_right(cur_s);
+      double w_left = width_left(cur_s);
 
       contour_line.setColor(1., 0., 0.); // Red contour error
       contour_line.addLine(path_point, path_point + dpath * contour_error, 0.1);
@@ -12,41 +12,33 @@ namespace MPCPlanner
     {
     }
 
-    void CurvatureAwareContouring::setParameters(const RealTimeData &data, const ModuleData &module_data, int k)
+    void CurvatureAwareContouring::readWeights()
     {
-        (void)data;
-        (void)module_data;
+        // There is no lag term
+        const ConfigSnapshot &config = CONFIG_SNAPSHOT;
+        _contouring_weight = config.weight("contour");
 
-        // Retrieve weights once
-        static double contouring_weight, reference_velocity, velocity_weight;
-        static double terminal_angle_weight, terminal_contouring_weight;
-        if (k == 0)
-        {
-            contouring_weight = CONFIG["weights"]["contour"].as<double>();
-
-            terminal_angle_weight = CONFIG["weights"]["terminal_angle"].as<double>();
-            terminal_contouring_weight = CONFIG["weights"]["terminal_contouring"].as<double>();
+        _terminal_angle_weight = config.weight("terminal_angle");
+        _terminal_contouring_weight = config.weight("terminal_contouring");
 
-            if (_dynamic_velocity_reference)
-            {
-                velocity_weight = CONFIG["weights"]["velocity"].as<double>();
-                reference_velocity = CONFIG["weights"]["reference_velocity"].as<double>();
-            }
+        if (_dynamic_velocity_reference)
+        {
+            _velocity_weight = config.weight("velocity");
+            _reference_velocity = config.weight("reference_velocity");
         }
+    }
 
-        {
-            setSolverParameterContour(k, _solver->_params, contouring_weight);
+    void CurvatureAwareContouring::setWeightParameters(int k)
+    {
+        setSolverParameterContour(k, _solver->_params, _contouring_weight);
 
-            setSolverParameterTerminalAngle(k, _solver->_params, terminal_angle_weight);
-            setSolverParameterTerminalContouring(k, _solver->_params, terminal_contouring_weight);
+        setSolverParameterTerminalAngle(k, _solver->_params, _terminal_angle_weight);
+        setSolverParameterTerminalContouring(k, _solver->_params, _terminal_contouring_weight);
 
-            if (_dynamic_velocity_reference)
-            {
-                setSolverParameterVelocity(k, _solver->_params, velocity_weight);
-                setSolverParameterReferenceVelocity(k, _solver->_params, reference_velocity);
-            }
+        if (_dynamic_velocity_reference)
+        {
+            setSolverParameterVelocity(k, _solver->_params, _velocity_weight);
+            setSolverParameterReferenceVelocity(k, _solver->_params, _reference_velocity);
         }
-
-        setSplineParameters(k);
     }
 }
\ No newline at end of file
@@ -25,7 +25,10 @@ namespace MPCPlanner
     double range = CONFIG["decomp"]["range"].as<double>();
     _decomp_util->set_local_bbox(Vec2f(range, range));
 
-    _occ_pos.reserve(1000); // Reserve some space for the occupied positions
+    if (CONFIG["decomp"]["threads"].IsDefined())
+      _decomp_util->set_num_threads(CONFIG["decomp"]["threads"].as<int>()); // Dilates the stages in parallel
+
+    _path.reserve(CONFIG["N"].as<int>());
 
     _n_discs = CONFIG["n_discs"].as<int>(); // Is overwritten to 1 for topology constraints
 
@@ -57,30 +60,30 @@ namespace MPCPlanner
     PROFILE_SCOPE("DecompConstraints::Update");
     LOG_MARK("DecompConstraints::update");
 
-    _dummy_b = state.get("x") + 100.;
+    _dummy_b = state.get(Layout::Var::X) + 100.;
 
     getOccupiedGridCells(data); // Retrieve occupied points from the costmap
 
-    _decomp_util->set_obs(_occ_pos); // Set them
+    _decomp_util->set_obs(_occupied_cells.getPositions()); // Set them
 
     // getPath(path);
 
-    vec_Vec2f path;
-    double s = state.get("spline");
+    _path.clear();
+    double s = state.get(Layout::Var::SPLINE);
     for (int k = 0; k < _solver->N; k++)
     {
       // Local path //
-      // path.emplace_back(_solver->getEgoPrediction(k, "x"), _solver->getEgoPrediction(k, "y")); // k = 0 is initial state
+      // path.emplace_back(_solver->getEgoPrediction(k, Layout::Var::X), _solver->getEgoPrediction(k, Layout::Var::Y)); // k = 0 is initial state
 
       // Global (reference) path //
       auto path_pos = module_data.path->getPoint(s);
-      path.emplace_back(path_pos(0), path_pos(1));
+      _path.emplace_back(path_pos(0), path_pos(1));
 
-      double v = _solver->getEgoPrediction(k, "v"); // Use the predicted velocity
+      double v = _solver->getEgoPrediction(k, Layout::Var::V); // Use the predicted velocity
 
-      s += v * _solver->dt;
+      s += v * _solver->getTimeStep(k);
     }
-    _decomp_util->dilate(path, 0, false);
+    _decomp_util->dilate(_path, 0, false);
 
     _decomp_util->set_constraints(_constraints, 0.); // Map is already inflated
     _polyhedrons = _decomp_util->get_polyhedrons();
@@ -124,25 +127,13 @@ namespace MPCPlanner
     PROFILE_FUNCTION();
     LOG_MARK("GetOccupiedGridCells");
 
-    const auto &costmap = *data.costmap;
-
-    // Store all occupied cells in the grid map
-    _occ_pos.clear();
-    double x, y;
-    for (unsigned int i = 0; i < costmap.getSizeInCellsX(); i++)
-    {
-      for (unsigned int j = 0; j < costmap.getSizeInCellsY(); j++)
-      {
-        if (costmap.getCost(i, j) == costmap_2d::FREE_SPACE)
-          continue;
-
-        costmap.mapToWorld(i, j, x, y);
-        // LOG_INFO("Obstacle at x = " << x << ", y = " << y);
+    // Only the cells that changed since the last cycle are added or removed
+    _occupied_cells.update(*data.costmap);
 
-        _occ_pos.emplace_back(x, y);
-      }
-    }
-    // LOG_VALUE("Occupied cells", _occ_pos.size());
+    const auto &statistics = _occupied_cells.getStatistics();
+    LOG_MARK("Occupied cells: " << statistics.occupied_cells << " (" << statistics.changed_cells << " changed in "
+                                << statistics.changed_rows << " rows, shifted by [" << statistics.shift_x << ", "
+                                << statistics.shift_y << "]" << (statistics.rebuilt ? ", rebuilt" : "") << ")");
 
     return true;
   }
@@ -201,20 +192,25 @@ namespace MPCPlanner
 
   void DecompConstraints::projectToSafety(Eigen::Vector2d &pos)
   {
-    // Too slow
-    if (_occ_pos.empty()) // There is no anchor
+    const vec_Vec2f &occ_pos = _occupied_cells.getPositions();
+    if (occ_pos.empty()) // There is no anchor
       return;
 
-    // Project to a collision free position if necessary, considering all the obstacles
-    for (int iterate = 0; iterate < 1; iterate++) // At most 3 iterations
-    {
-      for (auto &obs : _occ_pos)
-      {
-        double radius = CONFIG["robot_radius"].as<double>() + 0.1;
+    // The occupied positions are read in place (x and y interleaved)
+    const int n = occ_pos.size();
+    Eigen::Map<const Eigen::ArrayXd, 0, Eigen::InnerStride<2>> occ_x(occ_pos[0].data(), n), occ_y(occ_pos[0].data() + 1, n);
 
-        dr_projection_.douglasRachfordProjection(pos, obs, _occ_pos[0], radius, pos);
-      }
-    }
+    // Project to a collision free position if necessary, considering the occupied cells that are close
+    double radius = CONFIG_SNAPSHOT.robot_radius + 0.1;
+    _projection.project(pos, occ_x, occ_y, radius, occ_pos[0], 2. * radius, 3); // At most 3 iterations
+  }
+
+  bool DecompConstraints::snapshotVisuals()
+  {
+    _visual_polyhedrons = _polyhedrons;
+    if (CONFIG_SNAPSHOT.debug_visuals)
+      _visual_occupied_cells = _occupied_cells.getPositions();
+    return true;
   }
 
   void DecompConstraints::visualize(const RealTimeData &data, const ModuleData &module_data)
@@ -232,9 +228,9 @@ namespace MPCPlanner
 
     auto &polyline = publisher.getNewLine();
     polyline.setScale(0.1, 0.1);
-    for (int k = 0; k < _solver->N; k += CONFIG["visualization"]["draw_every"].as<int>())
+    for (int k = 0; k < _solver->N; k += CONFIG_SNAPSHOT.draw_every)
     {
-      const auto &poly = _polyhedrons[k];
+      const auto &poly = _visual_polyhedrons[k];
       polyline.setColorInt(k, _solver->N);
 
       const auto vertices = cal_vertices(poly);
@@ -259,7 +255,7 @@ namespace MPCPlanner
 
     publisher.publish();
 
-    if (!CONFIG["debug_visuals"].as<bool>())
+    if (!CONFIG_SNAPSHOT.debug_visuals)
       return;
 
     LOG_MARK("DecompConstraints::Visualize");
@@ -269,7 +265,7 @@ namespace MPCPlanner
     point.setScale(0.1, 0.1, 0.1);
     point.setColor(0, 0, 0, 1);
 
-    for (auto &vec : _occ_pos)
+    for (auto &vec : _visual_occupied_cells)
     {
       point.addPointMarker(Eigen::Vector3d(vec.x(), vec.y(), 0));
     }
@@ -19,6 +19,8 @@ namespace MPCPlanner
     _n_discs = CONFIG["n_discs"].as<int>();
     _robot_radius = CONFIG["robot_radius"].as<double>();
     _risk = CONFIG["probabilistic"]["risk"].as<double>();
+    _chi = RosTools::ExponentialQuantile(0.5, 1.0 - _risk);
+    _max_obstacles = CONFIG["max_obstacles"].as<unsigned int>();
   }
 
   void EllipsoidConstraints::update(State &state, const RealTimeData &data, ModuleData &module_data)
@@ -27,8 +29,8 @@ namespace MPCPlanner
     (void)data;
     (void)module_data;
 
-    _dummy_x = state.get("x") + 50;
-    _dummy_y = state.get("y") + 50;
+    _dummy_x = state.get(Layout::Var::X) + 50;
+    _dummy_y = state.get(Layout::Var::Y) + 50;
   }
 
   void EllipsoidConstraints::setParameters(const RealTimeData &data, const ModuleData &module_data, int k)
@@ -61,12 +63,13 @@ namespace MPCPlanner
     for (size_t i = 0; i < data.dynamic_obstacles.size(); i++)
     {
       const auto &obstacle = data.dynamic_obstacles[i];
-      const auto &mode = obstacle.prediction.modes[0];
 
-      /** @note The first prediction step is index 1 of the optimization problem, i.e., k-1 maps to the predictions for this stage */
-      setSolverParameterEllipsoidObstX(k, _solver->_params, mode[k - 1].position(0), i);
-      setSolverParameterEllipsoidObstY(k, _solver->_params, mode[k - 1].position(1), i);
-      setSolverParameterEllipsoidObstPsi(k, _solver->_params, mode[k - 1].angle, i);
+      /** @note The first prediction step is index 1 of the optimization problem, i.e., k-1 maps to the predictions for this stage.
+       * Predictions are uniform in integrator_step, the stage times may not be */
+      const PredictionStep prediction = interpolatePrediction(obstacle.prediction.modes[0], _solver->getPredictionTime(k), _solver->dt);
+      setSolverParameterEllipsoidObstX(k, _solver->_params, prediction.position(0), i);
+      setSolverParameterEllipsoidObstY(k, _solver->_params, prediction.position(1), i);
+      setSolverParameterEllipsoidObstPsi(k, _solver->_params, prediction.angle, i);
       setSolverParameterEllipsoidObstR(k, _solver->_params, obstacle.radius, i);
 
       if (obstacle.prediction.type == PredictionType::DETERMINISTIC)
@@ -77,11 +80,10 @@ namespace MPCPlanner
       }
       else if (obstacle.prediction.type == PredictionType::GAUSSIAN)
       {
-        double chi = RosTools::ExponentialQuantile(0.5, 1.0 - _risk);
 
-        setSolverParameterEllipsoidObstMajor(k, _solver->_params, mode[k - 1].major_radius, i);
-        setSolverParameterEllipsoidObstMinor(k, _solver->_params, mode[k - 1].minor_radius, i);
-        setSolverParameterEllipsoidObstChi(k, _solver->_params, chi, i);
+        setSolverParameterEllipsoidObstMajor(k, _solver->_params, prediction.major_radius, i);
+        setSolverParameterEllipsoidObstMinor(k, _solver->_params, prediction.minor_radius, i);
+        setSolverParameterEllipsoidObstChi(k, _solver->_params, _chi, i);
       }
     }
 
@@ -97,7 +99,7 @@ namespace MPCPlanner
       return false;
     }
 
-    if (data.dynamic_obstacles.size() != CONFIG["max_obstacles"].as<unsigned int>())
+    if (data.dynamic_obstacles.size() != _max_obstacles)
     {
       missing_data += "Obstacles ";
       return false;
@@ -16,6 +16,7 @@ namespace MPCPlanner
       : ControllerModule(ModuleType::CONSTRAINT, solver, "gaussian_constraints")
   {
     LOG_INITIALIZE("Gaussian Constraints");
+    _max_obstacles = CONFIG["max_obstacles"].as<unsigned int>();
     LOG_INITIALIZED();
   }
 
@@ -24,16 +25,22 @@ namespace MPCPlanner
     (void)state;
     (void)data;
     (void)module_data;
-    _dummy_x = state.get("x") + 100.;
-    _dummy_y = state.get("y") + 100.;
+    _dummy_x = state.get(Layout::Var::X) + 100.;
+    _dummy_y = state.get(Layout::Var::Y) + 100.;
+
+    const ConfigSnapshot &config = CONFIG_SNAPSHOT;
+    _robot_radius = config.robot_radius;
+    _n_discs = config.n_discs;
+    _risk = config.risk;
+    _obstacle_radius = config.obstacle_radius;
   }
 
   void GaussianConstraints::setParameters(const RealTimeData &data, const ModuleData &module_data, int k)
   {
     (void)module_data;
 
-    setSolverParameterEgoDiscRadius(k, _solver->_params, CONFIG["robot_radius"].as<double>());
-    for (int d = 0; d < CONFIG["n_discs"].as<int>(); d++)
+    setSolverParameterEgoDiscRadius(k, _solver->_params, _robot_radius);
+    for (int d = 0; d < _n_discs; d++)
       setSolverParameterEgoDiscOffset(k, _solver->_params, data.robot_area[d].offset, d);
 
     if (k == 0) // Dummies
@@ -51,36 +58,35 @@ namespace MPCPlanner
       return;
     }
 
-    std::vector<DynamicObstacle> copied_obstacles = data.dynamic_obstacles;
-
-    for (size_t i = 0; i < copied_obstacles.size(); i++)
+    for (size_t i = 0; i < data.dynamic_obstacles.size(); i++)
     {
-      const auto &obstacle = copied_obstacles[i];
+      const auto &obstacle = data.dynamic_obstacles[i];
 
       if (obstacle.prediction.type == PredictionType::GAUSSIAN)
       {
-        setSolverParameterGaussianObstX(k, _solver->_params, obstacle.prediction.modes[0][k - 1].position(0), i);
-        setSolverParameterGaussianObstY(k, _solver->_params, obstacle.prediction.modes[0][k - 1].position(1), i);
+        const PredictionStep prediction = interpolatePrediction(obstacle.prediction.modes[0], _solver->getPredictionTime(k), _solver->dt);
+        setSolverParameterGaussianObstX(k, _solver->_params, prediction.position(0), i);
+        setSolverParameterGaussianObstY(k, _solver->_params, prediction.position(1), i);
 
         if (obstacle.type == ObstacleType::DYNAMIC)
         {
-          setSolverParameterGaussianObstMajor(k, _solver->_params, obstacle.prediction.modes[0][k - 1].major_radius, i);
-          setSolverParameterGaussianObstMinor(k, _solver->_params, obstacle.prediction.modes[0][k - 1].minor_radius, i);
+          setSolverParameterGaussianObstMajor(k, _solver->_params, prediction.major_radius, i);
+          setSolverParameterGaussianObstMinor(k, _solver->_params, prediction.minor_radius, i);
         }
         else // Static obstacles have no uncertainty
         {
           setSolverParameterGaussianObstMajor(k, _solver->_params, 0.001, i);
           setSolverParameterGaussianObstMinor(k, _solver->_params, 0.001, i);
         }
-        setSolverParameterGaussianObstRisk(k, _solver->_params, CONFIG["probabilistic"]["risk"].as<double>(), i);
-        setSolverParameterGaussianObstR(k, _solver->_params, CONFIG["obstacle_radius"].as<double>(), i);
+        setSolverParameterGaussianObstRisk(k, _solver->_params, _risk, i);
+        setSolverParameterGaussianObstR(k, _solver->_params, _obstacle_radius, i);
       }
     }
   }
 
   bool GaussianConstraints::isDataReady(const RealTimeData &data, std::string &missing_data)
   {
-    if (data.dynamic_obstacles.size() != CONFIG["max_obstacles"].as<unsigned int>())
+    if (data.dynamic_obstacles.size() != _max_obstacles)
     {
       missing_data += "Obstacles ";
       return false;
@@ -104,6 +110,15 @@ namespace MPCPlanner
     return true;
   }
 
+  bool GaussianConstraints::snapshotVisuals()
+  {
+    _visual_risk = _risk;
+    _visual_prediction_times.resize(_solver->N);
+    for (int k = 1; k < _solver->N; k++)
+      _visual_prediction_times[k] = _solver->getPredictionTime(k);
+    return true;
+  }
+
   void GaussianConstraints::visualize(const RealTimeData &data, const ModuleData &module_data)
   {
     (void)module_data;
@@ -116,17 +131,18 @@ namespace MPCPlanner
     for (auto &obstacle : data.dynamic_obstacles)
     {
 
-      for (int k = 1; k < _solver->N; k += CONFIG["visualization"]["draw_every"].as<int>())
+      for (int k = 1; k < _solver->N; k += CONFIG_SNAPSHOT.draw_every)
       {
         ellipsoid.setColorInt(k, _solver->N, 0.5);
 
         double chi = obstacle.type == ObstacleType::DYNAMIC
-                         ? RosTools::ExponentialQuantile(0.5, 1.0 - CONFIG["probabilistic"]["risk"].as<double>())
+                         ? RosTools::ExponentialQuantile(0.5, 1.0 - _visual_risk)
                          : 0.;
-        ellipsoid.setScale(2 * (obstacle.prediction.modes[0][k - 1].major_radius * std::sqrt(chi) + obstacle.radius),
-                           2 * (obstacle.prediction.modes[0][k - 1].major_radius * std::sqrt(chi) + obstacle.radius), 0.005);
+        const PredictionStep prediction = interpolatePrediction(obstacle.prediction.modes[0], _visual_prediction_times[k], _solver->dt);
+        ellipsoid.setScale(2 * (prediction.major_radius * std::sqrt(chi) + obstacle.radius),
+                           2 * (prediction.major_radius * std::sqrt(chi) + obstacle.radius), 0.005);
 
-        ellipsoid.addPointMarker(obstacle.prediction.modes[0][k - 1].position);
+        ellipsoid.addPointMarker(prediction.position);
       }
     }
     publisher.publish();
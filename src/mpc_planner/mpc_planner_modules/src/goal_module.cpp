@@ -23,6 +23,8 @@ namespace MPCPlanner
         (void)state;
         (void)data;
         (void)module_data;
+
+        _goal_weight = CONFIG_SNAPSHOT.weight("goal");
     }
 
     void GoalModule::setParameters(const RealTimeData &data, const ModuleData &module_data, int k)
@@ -33,7 +35,22 @@ namespace MPCPlanner
 
         setSolverParameterGoalX(k, _solver->_params, data.goal(0));
         setSolverParameterGoalY(k, _solver->_params, data.goal(1));
-        setSolverParameterGoalWeight(k, _solver->_params, CONFIG["weights"]["goal"].as<double>());
+        setSolverParameterGoalWeight(k, _solver->_params, _goal_weight);
+    }
+
+    void GoalModule::setParametersRange(const RealTimeData &data, const ModuleData &module_data, int k_begin, int k_end)
+    {
+        (void)module_data;
+        if (k_begin == 0)
+            LOG_MARK("Goal Module::setParametersRange()");
+
+        const double goal_x = data.goal(0), goal_y = data.goal(1);
+        for (int k = k_begin; k < k_end; k++)
+        {
+            setSolverParameterGoalX(k, _solver->_params, goal_x);
+            setSolverParameterGoalY(k, _solver->_params, goal_y);
+            setSolverParameterGoalWeight(k, _solver->_params, _goal_weight);
+        }
     }
 
     bool GoalModule::isDataReady(const RealTimeData &data, std::string &missing_data)
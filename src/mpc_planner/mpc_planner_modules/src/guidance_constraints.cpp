@@ -10,14 +10,13 @@
 #include <ros_tools/data_saver.h>
 #include <ros_tools/math.h>
 
-#include <omp.h>
 
 namespace MPCPlanner
 {
-    GuidanceConstraints::LocalPlanner::LocalPlanner(int _id, bool _is_original_planner)
+    GuidanceConstraints::LocalPlanner::LocalPlanner(int _id, std::shared_ptr<Solver> solver, bool _is_original_planner)
         : id(_id), is_original_planner(_is_original_planner)
     {
-        local_solver = std::make_shared<Solver>(_id + 1); // Populate 1-n_solvers (leave 0 for the regular solver)
+        local_solver = solver;
         guidance_constraints = std::make_unique<LinearizedConstraints>(local_solver);
         safety_constraints = std::make_unique<GUIDANCE_CONSTRAINTS_TYPE>(local_solver);
 
@@ -36,8 +35,8 @@ namespace MPCPlanner
 
         _use_tmpcpp = CONFIG["t-mpc"]["use_t-mpc++"].as<bool>();
         _enable_constraints = CONFIG["t-mpc"]["enable_constraints"].as<bool>();
+        _keep_solver_memory = CONFIG["t-mpc"]["keep_solver_memory"].as<bool>();
         _control_frequency = CONFIG["control_frequency"].as<double>();
-        _planning_time = 1. / _control_frequency;
 
         // Initialize the constraint modules
         int n_solvers = global_guidance_->GetConfig()->n_paths_; // + 1 for the main lmpcc solver?
@@ -45,17 +44,26 @@ namespace MPCPlanner
         ROSTOOLS_ASSERT(n_solvers > 0 || _use_tmpcpp, "Guidance constraints cannot run with 0 paths and T-MPC++ disabled!");
 
         LOG_VALUE("Solvers", n_solvers);
+
+        // Populate 1-n_solvers (leave 0 for the regular solver)
+        std::vector<int> solver_ids;
+        for (int i = 0; i < n_solvers + (_use_tmpcpp ? 1 : 0); i++)
+            solver_ids.push_back(i + 1);
+        _batch_solvers = SolverBatch::createSolvers(solver_ids);
+
         for (int i = 0; i < n_solvers; i++)
         {
-            planners_.emplace_back(i);
+            planners_.emplace_back(i, _batch_solvers[i]);
         }
 
         if (_use_tmpcpp) // ADD IT AS FIRST PLAN
         {
             LOG_INFO("Using T-MPC++ (Adding the non-guided planner in parallel)");
-            planners_.emplace_back(n_solvers, true);
+            planners_.emplace_back(n_solvers, _batch_solvers[n_solvers], true);
         }
 
+        _solver_batch = std::make_unique<SolverBatch>(std::min((int)planners_.size(), 8));
+
         LOG_INITIALIZED();
     }
 
@@ -86,14 +94,14 @@ namespace MPCPlanner
             return;
 
         // Set the goals of the global guidance planner
-        global_guidance_->SetStart(state.getPos(), state.get("psi"), state.get("v"));
+        global_guidance_->SetStart(state.getPos(), state.get(Layout::Var::PSI), state.get(Layout::Var::V));
 
         if (module_data.path_velocity != nullptr)
-            global_guidance_->SetReferenceVelocity(module_data.path_velocity->operator()(state.get("spline")));
+            global_guidance_->SetReferenceVelocity(module_data.path_velocity->operator()(state.get(Layout::Var::SPLINE)));
         else
-            global_guidance_->SetReferenceVelocity(CONFIG["weights"]["reference_velocity"].as<double>());
+            global_guidance_->SetReferenceVelocity(CONFIG_SNAPSHOT.weight("reference_velocity"));
 
-        if (!CONFIG["enable_output"].as<bool>())
+        if (!CONFIG_SNAPSHOT.enable_output)
         {
             LOG_INFO_THROTTLE(15000, "Not propagating nodes (output is disabled)");
             global_guidance_->DoNotPropagateNodes();
@@ -116,21 +124,23 @@ namespace MPCPlanner
     {
         LOG_MARK("Setting guidance planner goals");
 
-        double current_s = state.get("spline");
-        double robot_radius = CONFIG["robot_radius"].as<double>();
+        double current_s = state.get(Layout::Var::SPLINE);
+        const ConfigSnapshot &config = CONFIG_SNAPSHOT;
+        double robot_radius = config.robot_radius;
 
         if (module_data.path_velocity == nullptr || module_data.path_width_left == nullptr || module_data.path_width_right == nullptr)
         {
-            global_guidance_->LoadReferencePath(std::max(0., state.get("spline")), module_data.path,
-                                                CONFIG["road"]["width"].as<double>() / 2. - robot_radius - 0.1,
-                                                CONFIG["road"]["width"].as<double>() / 2. - robot_radius - 0.1);
+            double road_width = module_data.road_width > 0. ? module_data.road_width : config.road_width;
+            global_guidance_->LoadReferencePath(std::max(0., state.get(Layout::Var::SPLINE)), module_data.path,
+                                                road_width / 2. - robot_radius - 0.1,
+                                                road_width / 2. - robot_radius - 0.1);
             return;
         }
 
         // Define goals along the reference path, taking into account the velocity along the path
         double final_s = current_s;
         for (int k = 1; k < global_guidance_->GetConfig()->N; k++) // Euler integrate the velocity along the path
-            final_s += module_data.path_velocity->operator()(final_s) * _solver->dt;
+            final_s += module_data.path_velocity->operator()(final_s) * _solver->getTimeStep(k - 1);
 
         int n_long = global_guidance_->GetConfig()->longitudinal_goals_;
         int n_lat = global_guidance_->GetConfig()->vertical_goals_;
@@ -255,7 +265,6 @@ namespace MPCPlanner
         (void)data;
         if (k == 0)
         {
-            _solver->_params.solver_timeout = 0.02; // Should not do anything
 
             LOG_MARK("Guidance Constraints does not need to set parameters");
         }
@@ -264,85 +273,93 @@ namespace MPCPlanner
     int GuidanceConstraints::optimize(State &state, const RealTimeData &data, ModuleData &module_data)
     {
         PROFILE_FUNCTION();
-        // Required for parallel call to the solvers when using Forces
-        omp_set_nested(1);
-        omp_set_max_active_levels(2);
-        omp_set_dynamic(0);
         LOG_MARK("Guidance Constraints: optimize");
 
         if (!_use_tmpcpp && !global_guidance_->Succeeded())
             return 0;
 
-        bool shift_forward = CONFIG["shift_previous_solution_forward"].as<bool>() &&
-                             CONFIG["enable_output"].as<bool>();
+        bool shift_forward = CONFIG_SNAPSHOT.shift_previous_solution_forward &&
+                             CONFIG_SNAPSHOT.enable_output;
 
-#pragma omp parallel for num_threads(8)
         for (auto &planner : planners_)
         {
-            PROFILE_SCOPE("Guidance Constraints: Parallel Optimization");
             planner.result.Reset();
-            planner.disabled = false;
+            planner.disabled = planner.id >= global_guidance_->NumberOfGuidanceTrajectories() && // Only enable the solvers that are needed
+                               !planner.is_original_planner;                                     // We still want to add the original planner!
+        }
 
-            if (planner.id >= global_guidance_->NumberOfGuidanceTrajectories()) // Only enable the solvers that are needed
+        // Set up and solve all planners in parallel (before the solver deadline of the planner's cycle scheduler)
+        _solver_batch->solve(
+            _batch_solvers, [&](int p, Solver &solver)
             {
-                if (!planner.is_original_planner) // We still want to add the original planner!
+                PROFILE_SCOPE("Guidance Constraints: Parallel Optimization");
+                auto &planner = planners_[p];
+                if (planner.disabled)
+                    return false;
+
+                // Copy the data from the main solver
+                LOG_MARK("Planner [" << planner.id << "]: Copying data from main solver");
+                solver = *_solver; // Copy the main solver
+
+                // The multipliers of the previous cycle only fit if this planner follows the same homotopy class
+                // (with keep_solver_memory disabled every planner starts cold, to measure what the warm starts save)
+                if (!_keep_solver_memory || (!planner.is_original_planner && !planner.existing_guidance))
+                    solver.resetSolverMemory();
+
+                // CONSTRUCT CONSTRAINTS
+                if (planner.is_original_planner || (!_enable_constraints))
                 {
-                    planner.disabled = true;
-                    continue;
+                    planner.guidance_constraints->update(state, empty_data_, module_data);
+                    planner.safety_constraints->update(state, data, module_data); // Updates collision avoidance constraints
                 }
-            }
+                else
+                {
+                    LOG_MARK("Planner [" << planner.id << "]: Loading guidance into the solver and constructing constraints");
 
-            // Copy the data from the main solver
-            auto &solver = planner.local_solver;
-            LOG_MARK("Planner [" << planner.id << "]: Copying data from main solver");
-            *solver = *_solver; // Copy the main solver
+                    if (CONFIG_SNAPSHOT.warmstart_with_mpc_solution && planner.existing_guidance)
+                        solver.initializeWarmstart(state, shift_forward);
+                    else
+                        initializeSolverWithGuidance(planner);
 
-            // CONSTRUCT CONSTRAINTS
-            if (planner.is_original_planner || (!_enable_constraints))
-            {
-                planner.guidance_constraints->update(state, empty_data_, module_data);
-                planner.safety_constraints->update(state, data, module_data); // Updates collision avoidance constraints
-            }
-            else
-            {
-                LOG_MARK("Planner [" << planner.id << "]: Loading guidance into the solver and constructing constraints");
+                    planner.guidance_constraints->update(state, data, module_data); // Updates linearization of constraints
+                    planner.safety_constraints->update(state, data, module_data);   // Updates collision avoidance constraints
+                }
 
-                if (CONFIG["t-mpc"]["warmstart_with_mpc_solution"].as<bool>() && planner.existing_guidance)
-                    planner.local_solver->initializeWarmstart(state, shift_forward);
-                else
-                    initializeSolverWithGuidance(planner);
+                // LOAD PARAMETERS
+                LOG_MARK("Planner [" << planner.id << "]: Loading updated parameters into the solver");
+                for (int k = 0; k < _solver->N; k++)
+                {
+                    if (planner.is_original_planner)
+                        planner.guidance_constraints->setParameters(empty_data_, module_data, k); // Set this solver's parameters
+                    else
+                        planner.guidance_constraints->setParameters(data, module_data, k); // Set this solver's parameters
 
-                planner.guidance_constraints->update(state, data, module_data); // Updates linearization of constraints
-                planner.safety_constraints->update(state, data, module_data);   // Updates collision avoidance constraints
-            }
+                    planner.safety_constraints->setParameters(data, module_data, k);
+                }
 
-            // LOAD PARAMETERS
-            LOG_MARK("Planner [" << planner.id << "]: Loading updated parameters into the solver");
-            for (int k = 0; k < _solver->N; k++)
-            {
-                if (planner.is_original_planner)
-                    planner.guidance_constraints->setParameters(empty_data_, module_data, k); // Set this solver's parameters
-                else
-                    planner.guidance_constraints->setParameters(data, module_data, k); // Set this solver's parameters
+                // if (enable_guidance_warmstart_)
+                solver.loadWarmstart();
+                LOG_MARK("Planner [" << planner.id << "]: Solving ...");
+                return true;
+            },
+            data.solver_deadline, SolverBatch::Policy::BEST_OBJECTIVE);
 
-                planner.safety_constraints->setParameters(data, module_data, k);
+        // ANALYSIS AND PROCESSING
+        for (size_t p = 0; p < planners_.size(); p++)
+        {
+            auto &planner = planners_[p];
+            const auto &batch_result = _solver_batch->getResult(p);
+            if (!batch_result.solved)
+            {
+                planner.disabled = true; // Skipped or out of time
+                continue;
             }
 
-            // Set timeout (Planning time - used time - time necessary afterwards)
-            std::chrono::duration<double> used_time = std::chrono::system_clock::now() - data.planning_start_time;
-            planner.local_solver->_params.solver_timeout = _planning_time - used_time.count() - 0.006;
-
-            // SOLVE OPTIMIZATION
-            // if (enable_guidance_warmstart_)
-            planner.local_solver->loadWarmstart();
-            LOG_MARK("Planner [" << planner.id << "]: Solving ...");
-            planner.result.exit_code = solver->solve();
-            // solver_results_[i].exit_code =ellipsoidal_constraints_[solver->solver_id_].Optimize(solver.get()); // IF THIS OPTIMIZATION EXISTS!
+            planner.result.exit_code = batch_result.exit_code;
             LOG_MARK("Planner [" << planner.id << "]: Done! (exitcode = " << planner.result.exit_code << ")");
 
-            // ANALYSIS AND PROCESSING
-            planner.result.success = planner.result.exit_code == 1;
-            planner.result.objective = solver->_info.pobj; // How good is the solution?
+            planner.result.success = batch_result.success;
+            planner.result.objective = batch_result.objective; // How good is the solution?
 
             if (planner.is_original_planner) // We did not use any guidance!
             {
@@ -360,7 +377,19 @@ namespace MPCPlanner
             }
         }
 
-        omp_set_dynamic(1);
+#ifdef ACADOS_SOLVER
+        // Iterations that the solvers needed, split by how they were warm started
+        for (auto &planner : planners_)
+        {
+            if (planner.disabled)
+                continue;
+
+            bool warm = planner.local_solver->_info.warm_start != WarmStartType::COLD;
+            _iteration_stats[warm].solves++;
+            _iteration_stats[warm].sqp_iterations += planner.local_solver->_info.sqp_iter;
+            _iteration_stats[warm].qp_iterations += planner.local_solver->_info.qp_iter;
+        }
+#endif
 
         {
             PROFILE_SCOPE("Decision");
@@ -402,14 +431,14 @@ namespace MPCPlanner
         {
             // int index = k + 1;
             int index = k;
-            Eigen::Vector2d cur_position = trajectory_spline.getPoint((double)(index)*solver->dt); // The plan is one ahead
+            Eigen::Vector2d cur_position = trajectory_spline.getPoint(solver->getStageTime(index)); // The plan is one ahead
             // global_guidance_->ProjectToFreeSpace(cur_position, k + 1);
-            solver->setEgoPrediction(k, "x", cur_position(0));
-            solver->setEgoPrediction(k, "y", cur_position(1));
+            solver->setEgoPrediction(k, Layout::Var::X, cur_position(0));
+            solver->setEgoPrediction(k, Layout::Var::Y, cur_position(1));
 
-            Eigen::Vector2d cur_velocity = trajectory_spline.getVelocity((double)(index)*solver->dt); // The plan is one ahead
-            solver->setEgoPrediction(k, "psi", std::atan2(cur_velocity(1), cur_velocity(0)));
-            solver->setEgoPrediction(k, "v", cur_velocity.norm());
+            Eigen::Vector2d cur_velocity = trajectory_spline.getVelocity(solver->getStageTime(index)); // The plan is one ahead
+            solver->setEgoPrediction(k, Layout::Var::PSI, std::atan2(cur_velocity(1), cur_velocity(0)));
+            solver->setEgoPrediction(k, Layout::Var::V, cur_velocity.norm());
         }
     }
 
@@ -443,25 +472,27 @@ namespace MPCPlanner
 
         // global_guidance_->Visualize(highlight_selected_guidance_, visualized_guidance_trajectory_nr_);
         if (!(_use_tmpcpp && global_guidance_->GetConfig()->n_paths_ == 0)) // If global guidance
-            global_guidance_->Visualize(CONFIG["t-mpc"]["highlight_selected"].as<bool>(), -1);
+            global_guidance_->Visualize(CONFIG_SNAPSHOT.highlight_selected, -1);
         for (size_t i = 0; i < planners_.size(); i++)
         {
             auto &planner = planners_[i];
             if (planner.disabled)
                 continue;
 
-            if (i == 0)
+            if (i == 0) // Drawn on this thread (see snapshotVisuals())
             {
+                planner.guidance_constraints->snapshotVisuals();
                 planner.guidance_constraints->visualize(data, module_data);
+                planner.safety_constraints->snapshotVisuals();
                 planner.safety_constraints->visualize(data, module_data);
             }
 
             // Visualize the warmstart
-            if (CONFIG["debug_visuals"].as<bool>())
+            if (CONFIG_SNAPSHOT.debug_visuals)
             {
                 Trajectory initial_trajectory;
                 for (int k = 1; k < planner.local_solver->N; k++)
-                    initial_trajectory.add(planner.local_solver->getEgoPrediction(k, "x"), planner.local_solver->getEgoPrediction(k, "y"));
+                    initial_trajectory.add(planner.local_solver->getEgoPrediction(k, Layout::Var::X), planner.local_solver->getEgoPrediction(k, Layout::Var::Y));
                 visualizeTrajectory(initial_trajectory, _name + "/warmstart_trajectories", false, 0.2, 20, 20);
             }
 
@@ -470,7 +501,7 @@ namespace MPCPlanner
             {
                 Trajectory trajectory;
                 for (int k = 1; k < _solver->N; k++)
-                    trajectory.add(planner.local_solver->getOutput(k, "x"), planner.local_solver->getOutput(k, "y"));
+                    trajectory.add(planner.local_solver->getOutput(k, Layout::Var::X), planner.local_solver->getOutput(k, Layout::Var::Y));
 
                 if ((int)i == best_planner_index_)
                     visualizeTrajectory(trajectory, _name + "/optimized_trajectories", false, 1.0, -1, 12, true, false);
@@ -485,7 +516,7 @@ namespace MPCPlanner
 
         {
             VISUALS.getPublisher(_name + "/optimized_trajectories").publish();
-            if (CONFIG["debug_visuals"].as<bool>())
+            if (CONFIG_SNAPSHOT.debug_visuals)
                 VISUALS.getPublisher(_name + "/warmstart_trajectories").publish();
         }
     }
@@ -527,7 +558,6 @@ namespace MPCPlanner
         {
             LOG_MARK("Guidance Constraints: Received dynamic obstacles");
 
-            // #pragma omp parallel for num_threads(8)
             for (auto &planner : planners_)
             {
                 planner.safety_constraints->onDataReceived(data, std::forward<std::string>(data_name));
@@ -580,12 +610,20 @@ namespace MPCPlanner
                 // {
                 //     data_saver.AddData(
                 //         "solver" + std::to_string(i) + "_plan" + std::to_string(k),
-                //         Eigen::Vector2d(_solver->getOutput(k, "x"), _solver->getOutput(k, "y")));
+                //         Eigen::Vector2d(_solver->getOutput(k, Layout::Var::X), _solver->getOutput(k, Layout::Var::Y)));
                 // }
             }
             // data_saver.AddData("active_constraints_" + std::to_string(planner.id), planner.guidance_constraints->NumActiveConstraints(planner.local_solver.get()));
         }
 
+        for (int warm = 0; warm < 2; warm++)
+        {
+            const auto &stats = _iteration_stats[warm];
+            std::string type = warm ? "warm" : "cold";
+            data_saver.AddData("avg_sqp_iterations_" + type, stats.solves > 0 ? (double)stats.sqp_iterations / (double)stats.solves : -1.);
+            data_saver.AddData("avg_qp_iterations_" + type, stats.solves > 0 ? (double)stats.qp_iterations / (double)stats.solves : -1.);
+        }
+
         data_saver.AddData("best_planner_idx", best_planner_index_);
         double best_objective = best_planner_index_ != -1 ? planners_[best_planner_index_].local_solver->_info.pobj : -1.;
 
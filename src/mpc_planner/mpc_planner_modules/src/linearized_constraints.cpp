@@ -1,6 +1,7 @@
 #include "mpc_planner_modules/linearized_constraints.h"
 
 #include <mpc_planner_solver/mpc_planner_parameters.h>
+#include <mpc_planner_solver/worker_pool.h>
 
 #include <mpc_planner_util/parameters.h>
 #include <mpc_planner_util/data_visualization.h>
@@ -19,6 +20,10 @@ namespace MPCPlanner
 
     _n_other_halfspaces = CONFIG["linearized_constraints"]["add_halfspaces"].as<int>();
     _max_obstacles = CONFIG["max_obstacles"].as<int>();
+    _robot_radius = CONFIG["robot_radius"].as<double>();
+    _obstacle_x = Eigen::ArrayXXd::Zero(_max_obstacles, CONFIG["N"].as<int>());
+    _obstacle_y = Eigen::ArrayXXd::Zero(_max_obstacles, CONFIG["N"].as<int>());
+    _obstacle_radius = Eigen::ArrayXd::Zero(_max_obstacles);
     int n_constraints = _max_obstacles + _n_other_halfspaces;
     _a1.resize(CONFIG["n_discs"].as<int>());
     _a2.resize(CONFIG["n_discs"].as<int>());
@@ -36,14 +41,27 @@ namespace MPCPlanner
       }
     }
 
+    // The stages are independent and can be split over threads (worthwhile for many obstacles and discs)
+    if (CONFIG["linearized_constraints"]["stage_threads"].IsDefined())
+    {
+      int stage_threads = std::min(CONFIG["linearized_constraints"]["stage_threads"].as<int>(), CONFIG["N"].as<int>() - 1);
+      if (stage_threads > 1)
+        _stage_workers = std::make_unique<WorkerPool>(stage_threads);
+    }
+    _projections.resize(_stage_workers ? _stage_workers->numWorkers() : 1);
+
     _num_obstacles = 0;
     LOG_INITIALIZED();
   }
 
+  LinearizedConstraints::~LinearizedConstraints() = default;
+
   void LinearizedConstraints::setTopologyConstraints()
   {
     _n_discs = 1; // Only one disc is used for the topology constraints
     _use_guidance = true;
+    _stage_workers.reset(); // The guidance planners already run in parallel
+    _projections.resize(1);
   }
 
   void LinearizedConstraints::update(State &state, const RealTimeData &data, ModuleData &module_data)
@@ -51,25 +69,70 @@ namespace MPCPlanner
     (void)state;
     LOG_MARK("LinearizedConstraints::update");
 
-    _dummy_b = state.get("x") + 100.;
+    _dummy_b = state.get(Layout::Var::X) + 100.;
 
-    // Thread safe
-    std::vector<DynamicObstacle> copied_obstacles = data.dynamic_obstacles;
-    _num_obstacles = copied_obstacles.size();
+    // The planner owns this data during the update (the caller passes a copy), so the obstacles are not copied again
+    const std::vector<DynamicObstacle> &obstacles = data.dynamic_obstacles;
+    _num_obstacles = obstacles.size();
 
-    // For all stages
-    for (int k = 1; k < _solver->N; k++)
+    packObstacles(obstacles);
+
+    if (_stage_workers)
     {
+      int num_stages = _solver->N - 1;
+      int num_ranges = _stage_workers->numWorkers();
+      _stage_workers->run(num_ranges, [&](int i)
+                          { computeHalfspaces(data, module_data, 1 + i * num_stages / num_ranges, 1 + (i + 1) * num_stages / num_ranges,
+                                              _projections[i]); });
+    }
+    else
+    {
+      computeHalfspaces(data, module_data, 1, _solver->N, _projections[0]);
+    }
+    LOG_MARK("LinearizedConstraints::update done");
+  }
+
+  void LinearizedConstraints::packObstacles(const std::vector<DynamicObstacle> &obstacles)
+  {
+    for (int i = 0; i < _num_obstacles; i++)
+    {
+      _obstacle_radius(i) = (_use_guidance ? 1e-3 : obstacles[i].radius) + _robot_radius;
+
+      // Obstacle positions at the time of each stage (the time grid may be non-uniform)
+      const Mode &mode = obstacles[i].prediction.modes[0];
+      for (int k = 1; k < _solver->N; k++)
+      {
+        const Eigen::Vector2d position = interpolatePrediction(mode, _solver->getPredictionTime(k), _solver->dt).position;
+        _obstacle_x(i, k) = position(0);
+        _obstacle_y(i, k) = position(1);
+      }
+    }
+
+    // A projection step moves the position by at most twice the radius of the obstacle
+    _cull_distance = _num_obstacles > 0 ? 2. * _obstacle_radius.head(_num_obstacles).maxCoeff() : 0.;
+  }
+
+  void LinearizedConstraints::computeHalfspaces(const RealTimeData &data, const ModuleData &module_data, int k_begin, int k_end,
+                                                CircleProjection &projection)
+  {
+    const int n = _num_obstacles;
+    const auto radius = _obstacle_radius.head(n);
+
+    for (int k = k_begin; k < k_end; k++)
+    {
+      const auto obstacle_x = _obstacle_x.col(k).head(n);
+      const auto obstacle_y = _obstacle_y.col(k).head(n);
+
       for (int d = 0; d < _n_discs; d++)
       {
-        Eigen::Vector2d pos(_solver->getEgoPrediction(k, "x"), _solver->getEgoPrediction(k, "y")); // k = 0 is initial state
+        Eigen::Vector2d pos(_solver->getEgoPrediction(k, Layout::Var::X), _solver->getEgoPrediction(k, Layout::Var::Y)); // k = 0 is initial state
 
         if (!_use_guidance) // Use discs and their positions
         {
           auto &disc = data.robot_area[d];
 
-          Eigen::Vector2d disc_pos = disc.getPosition(pos, _solver->getEgoPrediction(k, "psi"));
-          projectToSafety(copied_obstacles, k, disc_pos); // Ensure that the vehicle position is collision-free
+          Eigen::Vector2d disc_pos = disc.getPosition(pos, _solver->getEgoPrediction(k, Layout::Var::PSI));
+          projectToSafety(k, disc_pos, projection); // Ensure that the vehicle position is collision-free
 
           /** @todo Set projected disc position */
 
@@ -77,32 +140,22 @@ namespace MPCPlanner
         }
         else // Use the robot position
         {
-          projectToSafety(copied_obstacles, k, pos); // Ensure that the vehicle position is collision-free
+          projectToSafety(k, pos, projection); // Ensure that the vehicle position is collision-free
           /** @todo Set projected disc position */
         }
 
-        // For all obstacles
-        for (size_t obs_id = 0; obs_id < copied_obstacles.size(); obs_id++)
-        {
-          const auto &copied_obstacle = copied_obstacles[obs_id];
-          const Eigen::Vector2d &obstacle_pos = copied_obstacle.prediction.modes[0][k - 1].position;
-
-          double diff_x = obstacle_pos(0) - pos(0);
-          double diff_y = obstacle_pos(1) - pos(1);
-
-          double dist = (obstacle_pos - pos).norm();
-
-          // Compute the components of A for this obstacle (normalized normal vector)
-          _a1[d][k](obs_id) = diff_x / dist;
-          _a2[d][k](obs_id) = diff_y / dist;
+        // For all obstacles at once: A is the normalized vector towards the obstacle, b evaluates a point on the
+        // collision circle (b holds the inverse distance in between, the kernels do not allocate)
+        auto a1 = _a1[d][k].head(n);
+        auto a2 = _a2[d][k].head(n);
+        auto b = _b[d][k].head(n);
 
-          // Compute b (evaluate point on the collision circle)
-          double radius = _use_guidance ? 1e-3 : copied_obstacle.radius;
-
-          _b[d][k](obs_id) = _a1[d][k](obs_id) * obstacle_pos(0) +
-                             _a2[d][k](obs_id) * obstacle_pos(1) -
-                             (radius + CONFIG["robot_radius"].as<double>());
-        }
+        a1 = obstacle_x - pos(0);
+        a2 = obstacle_y - pos(1);
+        b = (a1.square() + a2.square()).rsqrt();
+        a1 *= b;
+        a2 *= b;
+        b = a1 * obstacle_x + a2 * obstacle_y - radius;
 
         if (!module_data.static_obstacles.empty() && (int)module_data.static_obstacles[k].size() < _n_other_halfspaces)
         {
@@ -116,7 +169,7 @@ namespace MPCPlanner
           int num_halfspaces = std::min((int)module_data.static_obstacles[k].size(), _n_other_halfspaces);
           for (int h = 0; h < num_halfspaces; h++)
           {
-            int obs_id = copied_obstacles.size() + h;
+            int obs_id = n + h;
             _a1[d][k](obs_id) = module_data.static_obstacles[k][h].A(0);
             _a2[d][k](obs_id) = module_data.static_obstacles[k][h].A(1);
             _b[d][k](obs_id) = module_data.static_obstacles[k][h].b;
@@ -124,27 +177,17 @@ namespace MPCPlanner
         }
       }
     }
-    LOG_MARK("LinearizedConstraints::update done");
   }
 
-  void LinearizedConstraints::projectToSafety(const std::vector<DynamicObstacle> &copied_obstacles, int k, Eigen::Vector2d &pos)
+  void LinearizedConstraints::projectToSafety(int k, Eigen::Vector2d &pos, CircleProjection &projection) const
   {
-    if (copied_obstacles.empty()) // There is no anchor
+    if (_num_obstacles == 0) // There is no anchor
       return;
 
-    // Project to a collision free position if necessary, considering all the obstacles
-    for (int iterate = 0; iterate < 3; iterate++) // At most 3 iterations
-    {
-      for (auto &obstacle : copied_obstacles)
-      {
-        double radius = _use_guidance ? 1e-3 : obstacle.radius;
-
-        dr_projection_.douglasRachfordProjection(pos, obstacle.prediction.modes[0][k - 1].position,
-                                                 copied_obstacles[0].prediction.modes[0][k - 1].position,
-                                                 radius + CONFIG["robot_radius"].as<double>(),
-                                                 pos);
-      }
-    }
+    // Project to a collision free position if necessary, considering the obstacles that are close
+    const int n = _num_obstacles;
+    projection.project(pos, _obstacle_x.col(k).head(n), _obstacle_y.col(k).head(n), _obstacle_radius.head(n),
+                       Eigen::Vector2d(_obstacle_x(0, k), _obstacle_y(0, k)), _cull_distance, 3); // At most 3 iterations
   }
 
   void LinearizedConstraints::setParameters(const RealTimeData &data, const ModuleData &module_data, int k)
@@ -215,10 +258,19 @@ namespace MPCPlanner
     return true;
   }
 
+  bool LinearizedConstraints::snapshotVisuals()
+  {
+    // Copy assignments reuse the memory of the previous copies
+    _visual_a1 = _a1[0];
+    _visual_a2 = _a2[0];
+    _visual_b = _b[0];
+    return true;
+  }
+
   void LinearizedConstraints::visualize(const RealTimeData &data, const ModuleData &module_data)
   {
     (void)module_data;
-    if (_use_guidance && !CONFIG["debug_visuals"].as<bool>())
+    if (_use_guidance && !CONFIG_SNAPSHOT.debug_visuals)
       return;
 
     PROFILE_FUNCTION();
@@ -227,7 +279,7 @@ namespace MPCPlanner
     {
       for (size_t i = 0; i < data.dynamic_obstacles.size(); i++)
       {
-        visualizeLinearConstraint(_a1[0][k](i), _a2[0][k](i), _b[0][k](i), k, _solver->N, _name,
+        visualizeLinearConstraint(_visual_a1[k](i), _visual_a2[k](i), _visual_b[k](i), k, _solver->N, _name,
                                   k == _solver->N - 1 && i == data.dynamic_obstacles.size() - 1); // Publish at the end
       }
     }
@@ -11,6 +11,18 @@ namespace MPCPlanner
       : ControllerModule(ModuleType::OBJECTIVE, solver, "mpc_base")
   {
     _weight_names = WEIGHT_PARAMS;
+
+    for (auto &weight : _weight_names)
+    {
+      _weight_indices.push_back(Layout::paramIndex(weight));
+      _config_indices.push_back(CONFIG_SNAPSHOT.weightIndex(weight.c_str()));
+      ROSTOOLS_ASSERT(_config_indices.back() >= 0, "All weights of the solver should be in the settings");
+    }
+    _weight_values.resize(_weight_names.size(), 0.);
+
+    _weights_consecutive = true;
+    for (size_t i = 1; i < _weight_indices.size(); i++)
+      _weights_consecutive &= _weight_indices[i] == _weight_indices[0] + (int)i;
   }
 
   void MPCBaseModule::update(State &state, const RealTimeData &data, ModuleData &module_data)
@@ -18,6 +30,11 @@ namespace MPCPlanner
     (void)state;
     (void)data;
     (void)module_data;
+
+    // Read the weights once per iteration (they may be changed by reconfigure)
+    const ConfigSnapshot &config = CONFIG_SNAPSHOT;
+    for (size_t i = 0; i < _weight_names.size(); i++)
+      _weight_values[i] = config.weights[_config_indices[i]];
   }
 
   void MPCBaseModule::setParameters(const RealTimeData &data, const ModuleData &module_data, int k)
@@ -28,9 +45,22 @@ namespace MPCPlanner
     if (k == 0)
       LOG_MARK("setParameters()");
 
-    for (auto &weight : _weight_names)
+    for (size_t i = 0; i < _weight_indices.size(); i++)
+      _solver->setParameter(k, _weight_indices[i], _weight_values[i]);
+  }
+
+  void MPCBaseModule::setParametersRange(const RealTimeData &data, const ModuleData &module_data, int k_begin, int k_end)
+  {
+    if (!_weights_consecutive || _weight_indices.empty())
     {
-      _solver->setParameter(k, weight, CONFIG["weights"][weight].as<double>());
+      ControllerModule::setParametersRange(data, module_data, k_begin, k_end);
+      return;
     }
+
+    if (k_begin == 0)
+      LOG_MARK("setParametersRange()");
+
+    for (int k = k_begin; k < k_end; k++)
+      _solver->setParameterBlock(k, _weight_indices[0], _weight_values.data(), _weight_values.size());
   }
 } // namespace MPCPlanner
\ No newline at end of file
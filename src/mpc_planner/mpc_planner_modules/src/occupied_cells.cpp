@@ -0,0 +1,169 @@
+#include "mpc_planner_modules/occupied_cells.h"
+
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/cost_values.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace MPCPlanner
+{
+  void OccupiedCells::update(const costmap_2d::Costmap2D &costmap)
+  {
+    _statistics = Statistics();
+
+    if (costmap.getSizeInCellsX() != _size_x || costmap.getSizeInCellsY() != _size_y || costmap.getResolution() != _resolution)
+    {
+      rebuild(costmap);
+    }
+    else
+    {
+      // A rolling window moves its origin by whole cells
+      int shift_x = (int)std::lround((costmap.getOriginX() - _origin_x) / _resolution);
+      int shift_y = (int)std::lround((costmap.getOriginY() - _origin_y) / _resolution);
+
+      _origin_x = costmap.getOriginX();
+      _origin_y = costmap.getOriginY();
+
+      if (std::abs(shift_x) >= (int)_size_x || std::abs(shift_y) >= (int)_size_y)
+        rebuild(costmap);
+      else if (shift_x != 0 || shift_y != 0)
+        shift(shift_x, shift_y);
+    }
+
+    // Compare with the previous costs, rows that did not change are skipped at once
+    _added.clear();
+    _removed.clear();
+    const unsigned char *costs = costmap.getCharMap();
+    for (unsigned int j = 0; j < _size_y; j++)
+    {
+      const unsigned int row_start = j * _size_x;
+      const unsigned char *row = costs + row_start;
+      unsigned char *previous_row = &_costs[row_start];
+      if (std::memcmp(row, previous_row, _size_x) == 0)
+        continue;
+
+      _statistics.changed_rows++;
+      for (unsigned int i = 0; i < _size_x; i++)
+      {
+        if (row[i] == previous_row[i])
+          continue;
+
+        bool occupied = row[i] != costmap_2d::FREE_SPACE;
+        if (occupied != (previous_row[i] != costmap_2d::FREE_SPACE))
+        {
+          if (occupied)
+            _added.push_back(i * _size_y + j);
+          else
+            _removed.push_back(i * _size_y + j);
+        }
+        previous_row[i] = row[i];
+      }
+    }
+
+    _statistics.changed_cells = _added.size() + _removed.size();
+    if (_statistics.changed_cells > 0)
+      merge();
+
+    _statistics.occupied_cells = _positions.size();
+  }
+
+  // Start from an empty map, all occupied cells are then added by the comparison
+  void OccupiedCells::rebuild(const costmap_2d::Costmap2D &costmap)
+  {
+    _statistics.rebuilt = true;
+
+    _size_x = costmap.getSizeInCellsX();
+    _size_y = costmap.getSizeInCellsY();
+    _resolution = costmap.getResolution();
+    _origin_x = costmap.getOriginX();
+    _origin_y = costmap.getOriginY();
+
+    _costs.assign(_size_x * _size_y, costmap_2d::FREE_SPACE);
+    _point_cell.clear();
+    _positions.clear();
+  }
+
+  // Cell (i, j) of the moved window is cell (i + shift_x, j + shift_y) of the previous window
+  void OccupiedCells::shift(int shift_x, int shift_y)
+  {
+    _statistics.shift_x = shift_x;
+    _statistics.shift_y = shift_y;
+
+    const int size_x = _size_x, size_y = _size_y;
+    const int i_begin = std::max(0, -shift_x);
+    const int i_end = std::min(size_x, size_x - shift_x);
+
+    // Cells that entered the window count as free before, so that their occupied cells are added
+    _shifted_costs.assign(_costs.size(), costmap_2d::FREE_SPACE);
+    for (int j = std::max(0, -shift_y); j < std::min(size_y, size_y - shift_y); j++)
+    {
+      std::memcpy(&_shifted_costs[j * size_x + i_begin], &_costs[(j + shift_y) * size_x + i_begin + shift_x],
+                  i_end - i_begin);
+    }
+    std::swap(_costs, _shifted_costs);
+
+    // Positions that left the window are dropped, the others move to their new cell (which keeps the scan order)
+    size_t num_kept = 0;
+    for (size_t p = 0; p < _positions.size(); p++)
+    {
+      int i = (int)(_point_cell[p] / _size_y) - shift_x;
+      int j = (int)(_point_cell[p] % _size_y) - shift_y;
+      if (i < 0 || i >= size_x || j < 0 || j >= size_y)
+        continue;
+
+      _point_cell[num_kept] = i * size_y + j;
+      _positions[num_kept] = cellCenter(_point_cell[num_kept]);
+      num_kept++;
+    }
+    _positions.resize(num_kept);
+    _point_cell.resize(num_kept);
+  }
+
+  // The positions and the changes are sorted by cell, so this is one pass over both
+  void OccupiedCells::merge()
+  {
+    std::sort(_added.begin(), _added.end());
+    std::sort(_removed.begin(), _removed.end());
+
+    _merged_positions.clear();
+    _merged_point_cell.clear();
+    _merged_positions.reserve(_positions.size() + _added.size());
+    _merged_point_cell.reserve(_positions.size() + _added.size());
+
+    size_t added = 0, removed = 0;
+    auto add_until = [&](unsigned int cell)
+    {
+      for (; added < _added.size() && _added[added] < cell; added++)
+      {
+        _merged_positions.push_back(cellCenter(_added[added]));
+        _merged_point_cell.push_back(_added[added]);
+      }
+    };
+
+    for (size_t p = 0; p < _positions.size(); p++)
+    {
+      add_until(_point_cell[p]);
+
+      if (removed < _removed.size() && _removed[removed] == _point_cell[p])
+      {
+        removed++;
+        continue;
+      }
+      _merged_positions.push_back(_positions[p]);
+      _merged_point_cell.push_back(_point_cell[p]);
+    }
+    add_until(_size_x * _size_y);
+
+    std::swap(_positions, _merged_positions);
+    std::swap(_point_cell, _merged_point_cell);
+  }
+
+  // As in Costmap2D::mapToWorld
+  Vec2f OccupiedCells::cellCenter(unsigned int cell) const
+  {
+    return Vec2f(_origin_x + ((cell / _size_y) + 0.5) * _resolution, _origin_y + ((cell % _size_y) + 0.5) * _resolution);
+  }
+} // namespace MPCPlanner
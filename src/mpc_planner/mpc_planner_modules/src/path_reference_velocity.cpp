@@ -7,6 +7,8 @@
 #include <ros_tools/visuals.h>
 #include <ros_tools/spline.h>
 
+#include <algorithm>
+
 namespace MPCPlanner
 {
 
@@ -14,6 +16,15 @@ namespace MPCPlanner
       : ControllerModule(ModuleType::OBJECTIVE, solver, "path_reference_velocity")
   {
     _n_segments = CONFIG["contouring"]["num_segments"].as<int>();
+
+    _velocity_block_values.resize(_n_segments * VELOCITY_BLOCK_SIZE);
+    for (int i = 0; i < _n_segments; i++)
+    {
+      std::string segment = std::to_string(i);
+      _velocity_block_index.push_back(Layout::paramIndex("spline_v" + segment + "_a"));
+      ROSTOOLS_ASSERT(Layout::paramIndex("spline_v" + segment + "_d") == _velocity_block_index.back() + VELOCITY_BLOCK_SIZE - 1,
+                      "The velocity spline parameters of a segment should be consecutive in the generated solver");
+    }
   }
 
   void PathReferenceVelocity::update(State &state, const RealTimeData &data, ModuleData &module_data)
@@ -23,6 +34,9 @@ namespace MPCPlanner
 
     if (module_data.path_velocity == nullptr && _velocity_spline != nullptr)
       module_data.path_velocity = _velocity_spline;
+
+    _reference_velocity = CONFIG_SNAPSHOT.weight("reference_velocity");
+    computeVelocityParameters(data, module_data); // The path segments are the same for all stages
   }
 
   void PathReferenceVelocity::onDataReceived(RealTimeData &data, std::string &&data_name)
@@ -41,67 +55,72 @@ namespace MPCPlanner
 
   void PathReferenceVelocity::setParameters(const RealTimeData &data, const ModuleData &module_data, int k)
   {
-    (void)module_data;
     (void)data;
+    (void)module_data;
 
-    static double reference_velocity; //, velocity_weight;
+    setVelocityParameters(k);
+  }
 
-    // Retrieve once
-    if (k == 0)
-    {
-      // velocity_weight = CONFIG["weights"]["velocity"].as<double>();
-      reference_velocity = CONFIG["weights"]["reference_velocity"].as<double>();
-    }
+  void PathReferenceVelocity::setParametersRange(const RealTimeData &data, const ModuleData &module_data, int k_begin, int k_end)
+  {
+    (void)data;
+    (void)module_data;
 
-    // Set the parameters for velocity tracking
-    // setSolverParameterVelocity(k, _solver->_params, velocity_weight);
+    for (int k = k_begin; k < k_end; k++)
+      setVelocityParameters(k);
+  }
 
+  void PathReferenceVelocity::computeVelocityParameters(const RealTimeData &data, const ModuleData &module_data)
+  {
     if (data.reference_path.hasVelocity()) // Use a spline-based velocity reference
     {
       LOG_MARK("Using spline-based reference velocity");
       for (int i = 0; i < _n_segments; i++)
       {
         int index = module_data.current_path_segment + i;
-        double a, b, c, d;
+        double *block = &_velocity_block_values[i * VELOCITY_BLOCK_SIZE];
 
         if (index < (int)_velocity_spline->m_x_.size() - 1)
         {
-          _velocity_spline->getParameters(index, a, b, c, d);
+          _velocity_spline->getParameters(index, block[0], block[1], block[2], block[3]);
         }
         else
         {
           // Brake at the end
-          a = 0.;
-          b = 0.;
-          c = 0.;
-          d = 0.;
+          std::fill_n(block, VELOCITY_BLOCK_SIZE, 0.);
         }
-
-        setSolverParameterSplineVA(k, _solver->_params, a, i);
-        setSolverParameterSplineVB(k, _solver->_params, b, i);
-        setSolverParameterSplineVC(k, _solver->_params, c, i);
-        setSolverParameterSplineVD(k, _solver->_params, d, i);
       }
     }
     else // Use a constant velocity reference
     {
       for (int i = 0; i < _n_segments; i++)
       {
-        setSolverParameterSplineVA(k, _solver->_params, 0., i);
-        setSolverParameterSplineVB(k, _solver->_params, 0., i);
-        setSolverParameterSplineVC(k, _solver->_params, 0., i);
-        setSolverParameterSplineVD(k, _solver->_params, reference_velocity, i); // v = d
+        double *block = &_velocity_block_values[i * VELOCITY_BLOCK_SIZE];
+        std::fill_n(block, VELOCITY_BLOCK_SIZE - 1, 0.);
+        block[3] = _reference_velocity; // v = d
       }
     }
   }
 
+  void PathReferenceVelocity::setVelocityParameters(int k)
+  {
+    for (int i = 0; i < _n_segments; i++)
+      _solver->setParameterBlock(k, _velocity_block_index[i], &_velocity_block_values[i * VELOCITY_BLOCK_SIZE], VELOCITY_BLOCK_SIZE);
+  }
+
+  bool PathReferenceVelocity::snapshotVisuals()
+  {
+    _visual_velocity_spline = _velocity_spline;
+    return true;
+  }
+
   void PathReferenceVelocity::visualize(const RealTimeData &data, const ModuleData &module_data)
   {
     (void)module_data;
     if (data.reference_path.empty() || data.reference_path.s.empty())
       return;
 
-    if (!CONFIG["debug_visuals"].as<bool>())
+    if (!CONFIG_SNAPSHOT.debug_visuals)
       return;
 
     LOG_MARK("PathReferenceVelocity::Visualize");
@@ -115,10 +134,10 @@ namespace MPCPlanner
 
     Eigen::Vector2d prev;
     double prev_v = 0.;
-    for (double s = 0.; s < _velocity_spline->m_x_.back(); s += 1.0)
+    for (double s = 0.; s < _visual_velocity_spline->m_x_.back(); s += 1.0)
     {
       Eigen::Vector2d cur = spline_xy->getPoint(s);
-      double v = _velocity_spline->operator()(s);
+      double v = _visual_velocity_spline->operator()(s);
 
       if (s > 0.)
       {
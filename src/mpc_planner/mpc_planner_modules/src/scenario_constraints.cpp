@@ -9,14 +9,13 @@
 
 #include <algorithm>
 
-#include <omp.h>
 
 namespace MPCPlanner
 {
 
-  ScenarioConstraints::ScenarioSolver::ScenarioSolver(int id)
+  ScenarioConstraints::ScenarioSolver::ScenarioSolver(std::shared_ptr<Solver> scenario_solver)
   {
-    solver = std::make_shared<Solver>(id);
+    solver = scenario_solver;
     scenario_module.initialize(solver);
   }
 
@@ -25,13 +24,15 @@ namespace MPCPlanner
   {
     LOG_INITIALIZE("Scenario Constraints");
 
-    _planning_time = 1. / CONFIG["control_frequency"].as<double>();
-
     _SCENARIO_CONFIG.Init();
+    std::vector<int> solver_ids;
     for (int i = 0; i < CONFIG["scenario_constraints"]["parallel_solvers"].as<int>(); i++)
-    {
-      _scenario_solvers.emplace_back(std::make_unique<ScenarioSolver>(i)); // May need an integer input
-    }
+      solver_ids.push_back(i);
+    _batch_solvers = SolverBatch::createSolvers(solver_ids);
+
+    for (auto &scenario_solver : _batch_solvers)
+      _scenario_solvers.emplace_back(std::make_unique<ScenarioSolver>(scenario_solver));
+    _solver_batch = std::make_unique<SolverBatch>(std::min((int)_scenario_solvers.size(), 4));
     LOG_INITIALIZED();
   }
 
@@ -39,13 +40,12 @@ namespace MPCPlanner
   {
     (void)state;
 
-#pragma omp parallel for num_threads(4)
-    for (auto &solver : _scenario_solvers)
-    {
-      *solver->solver = *_solver; // Copy the main solver, including its initial guess
+    _solver_batch->run(_scenario_solvers.size(), [&](int i)
+                       {
+                         auto &solver = _scenario_solvers[i];
+                         *solver->solver = *_solver; // Copy the main solver, including its initial guess
 
-      solver->scenario_module.update(data, module_data);
-    }
+                         solver->scenario_module.update(data, module_data); });
   }
 
   void ScenarioConstraints::setParameters(const RealTimeData &data, const ModuleData &module_data, int k)
@@ -60,45 +60,42 @@ namespace MPCPlanner
     (void)state;
     (void)module_data;
 
-    omp_set_nested(1);
-    omp_set_max_active_levels(2);
-    omp_set_dynamic(0);
-
-#pragma omp parallel for num_threads(4)
-    for (auto &solver : _scenario_solvers)
-    {
-      // Set the planning timeout
-      std::chrono::duration<double> used_time = std::chrono::system_clock::now() - data.planning_start_time;
-      solver->solver->_params.solver_timeout = _planning_time - used_time.count() - 0.008;
-
-      // Copy solver parameters and initial guess
-      *solver->solver = *_solver; // Copy the main solver
-
-      // Set the scenario constraint parameters for each solver
-      for (int k = 0; k < _solver->N; k++)
-      {
-        solver->scenario_module.setParameters(data, k);
-      }
+    // Solve all scenario solvers before the shared deadline and keep the lowest cost solution
+    int best = _solver_batch->solve(
+        _batch_solvers, [&](int i, Solver &solver)
+        {
+          // Copy solver parameters and initial guess
+          solver = *_solver; // Copy the main solver
+
+          // Set the scenario constraint parameters for each solver
+          for (int k = 0; k < _solver->N; k++)
+          {
+            _scenario_solvers[i]->scenario_module.setParameters(data, k);
+          }
+
+          solver.loadWarmstart(); // Load the previous solution
+          return true;
+        },
+        data.solver_deadline, SolverBatch::Policy::BEST_OBJECTIVE,
+        [&](int i, Solver &solver)
+        {
+          (void)solver;
+          return _scenario_solvers[i]->scenario_module.optimize(data); // Safe Horizon MPC
+        });
 
-      solver->solver->loadWarmstart(); // Load the previous solution
+    for (size_t i = 0; i < _scenario_solvers.size(); i++)
+      _scenario_solvers[i]->exit_code = _solver_batch->getResult(i).exit_code;
 
-      solver->exit_code = solver->scenario_module.optimize(data); // Safe Horizon MPC
-    }
-    omp_set_dynamic(1);
+    _best_solver = best == -1 ? nullptr : _scenario_solvers[best].get();
+    if (_best_solver == nullptr) // No feasible solution
+      return _scenario_solvers.front()->exit_code;
 
-    // Retrieve the lowest cost solution
-    double lowest_cost = 1e9;
-    _best_solver = nullptr;
+    // Failed solvers start the next cycle from the best solution instead of cold
     for (auto &solver : _scenario_solvers)
     {
-      if (solver->exit_code == 1 && solver->solver->_info.pobj < lowest_cost)
-      {
-        lowest_cost = solver->solver->_info.pobj;
-        _best_solver = solver.get();
-      }
+      if (!solver->solver->hasUsableSolution(solver->exit_code))
+        solver->solver->copySolverMemory(*_best_solver->solver);
     }
-    if (_best_solver == nullptr) // No feasible solution
-      return _scenario_solvers.front()->exit_code;
 
     _solver->_output = _best_solver->solver->_output; // Load the solution into the main lmpcc solver
     _solver->_info = _best_solver->solver->_info;
@@ -120,11 +117,8 @@ namespace MPCPlanner
       }
       if (_SCENARIO_CONFIG.enable_safe_horizon_)
       {
-#pragma omp parallel for num_threads(4)
-        for (auto &solver : _scenario_solvers) // Draw different samples for all solvers
-        {
-          solver->scenario_module.GetSampler().IntegrateAndTranslateToMeanAndVariance(data.dynamic_obstacles, _solver->dt);
-        }
+        _solver_batch->run(_scenario_solvers.size(), [&](int i) // Draw different samples for all solvers
+                           { _scenario_solvers[i]->scenario_module.GetSampler().IntegrateAndTranslateToMeanAndVariance(data.dynamic_obstacles, _solver->dt); });
       }
     }
   }
@@ -132,7 +126,7 @@ namespace MPCPlanner
   bool ScenarioConstraints::isDataReady(const RealTimeData &data, std::string &missing_data)
   {
 
-    if (data.dynamic_obstacles.size() != CONFIG["max_obstacles"].as<unsigned int>())
+    if (data.dynamic_obstacles.size() != CONFIG_SNAPSHOT.max_obstacles)
     {
       missing_data += "Obstacles ";
       return false;
@@ -180,11 +174,11 @@ namespace MPCPlanner
     // Visualize optimized trajectories
     for (auto &solver : _scenario_solvers)
     {
-      if (solver->exit_code == 1)
+      if (solver->solver->hasUsableSolution(solver->exit_code))
       {
         Trajectory trajectory;
         for (int k = 1; k < _solver->N; k++)
-          trajectory.add(solver->solver->getOutput(k, "x"), solver->solver->getOutput(k, "y"));
+          trajectory.add(solver->solver->getOutput(k, Layout::Var::X), solver->solver->getOutput(k, Layout::Var::Y));
 
         visualizeTrajectory(trajectory, _name + "/optimized_trajectories", false, 0.2, solver->solver->_solver_id, 2 * _scenario_solvers.size());
       }
@@ -0,0 +1,76 @@
+/**
+ * @file benchmark_module_dispatch.cpp
+ * @brief Compares setting the parameters of all stages through the dynamic module vector (virtual calls) with the
+ * generated module types (StaticModules). Requires a solver generated with solver_settings.static_modules. The module
+ * updates are not benchmarked, since they need a reference path, goal and costmap.
+ * Usage: benchmark_module_dispatch [settings.yaml] (default: the rosnavigation settings)
+ */
+#include <mpc_planner_modules/modules.h>
+
+#include <mpc_planner_solver/acados_solver_interface.h>
+
+#include <mpc_planner_types/realtime_data.h>
+#include <mpc_planner_types/module_data.h>
+
+#include <mpc_planner_util/load_yaml.hpp>
+#include <mpc_planner_util/parameters.h>
+
+#include <ros_tools/profiling.h>
+
+#include <iostream>
+#include <string>
+
+#ifndef MPC_PLANNER_STATIC_MODULES
+#error "Generate the solver with solver_settings.static_modules: true to benchmark the static module dispatch"
+#endif
+
+using namespace MPCPlanner;
+
+constexpr int REPETITIONS = 10000;
+
+int main(int argc, char **argv)
+{
+    std::string settings = argc > 1 ? argv[1] : SYSTEM_CONFIG_PATH(__FILE__, "../../mpc_planner_rosnavigation/config/settings");
+    Configuration::getInstance().initialize(settings);
+
+    auto solver = std::make_shared<Solver>();
+    std::vector<std::shared_ptr<ControllerModule>> modules;
+    initializeModules(modules, solver);
+    GeneratedModules static_modules(modules);
+
+    RealTimeData data;
+    for (int d = 0; d < CONFIG["n_discs"].as<int>(); d++)
+        data.robot_area.emplace_back(0., CONFIG["robot_radius"].as<double>());
+    ModuleData module_data;
+
+    auto &per_stage = BENCHMARKERS.getBenchmarker("parameters (virtual, per stage)");
+    auto &range = BENCHMARKERS.getBenchmarker("parameters (virtual, stage range)");
+    auto &static_dispatch = BENCHMARKERS.getBenchmarker("parameters (static dispatch)");
+
+    double checksum = 0.;
+    for (int r = 0; r < REPETITIONS; r++)
+    {
+        per_stage.start();
+        for (int k = 0; k < solver->N; k++)
+        {
+            for (auto &module : modules)
+                module->setParameters(data, module_data, k);
+        }
+        per_stage.stop();
+
+        range.start();
+        for (auto &module : modules)
+            module->setParametersRange(data, module_data, 0, solver->N);
+        range.stop();
+
+        static_dispatch.start();
+        static_modules.setParameters(data, module_data);
+        static_dispatch.stop();
+
+        checksum += solver->_params.all_parameters[r % (Layout::NUM_PARAMETERS * Layout::N)];
+    }
+
+    BENCHMARKERS.print();
+    std::cout << "checksum: " << checksum << std::endl;
+    return 0;
+}
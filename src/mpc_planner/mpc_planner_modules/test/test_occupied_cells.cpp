@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include "mpc_planner_modules/occupied_cells.h"
+
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/cost_values.h>
+
+#include <cmath>
+#include <random>
+
+using namespace MPCPlanner;
+
+namespace
+{
+    // The occupied cells as DecompConstraints read them before OccupiedCells: a full scan over x and then y
+    vec_Vec2f fullScan(const costmap_2d::Costmap2D &costmap)
+    {
+        vec_Vec2f positions;
+        double x, y;
+        for (unsigned int i = 0; i < costmap.getSizeInCellsX(); i++)
+        {
+            for (unsigned int j = 0; j < costmap.getSizeInCellsY(); j++)
+            {
+                if (costmap.getCost(i, j) == costmap_2d::FREE_SPACE)
+                    continue;
+
+                costmap.mapToWorld(i, j, x, y);
+                positions.emplace_back(x, y);
+            }
+        }
+        return positions;
+    }
+
+    // Static obstacles of the world, by world cell
+    unsigned char worldCost(long i, long j)
+    {
+        unsigned int hash = (unsigned int)(i * 73856093L ^ j * 19349663L);
+        return hash % 7 == 0 ? costmap_2d::LETHAL_OBSTACLE : costmap_2d::FREE_SPACE;
+    }
+
+    // Move the rolling window by whole cells and draw the world into the cells that entered it
+    void moveWindow(costmap_2d::Costmap2D &costmap, int shift_x, int shift_y)
+    {
+        // Half a cell further, as updateOrigin truncates the shift to whole cells
+        const double resolution = costmap.getResolution();
+        costmap.updateOrigin(costmap.getOriginX() + (shift_x + 0.5 * (shift_x > 0) - 0.5 * (shift_x < 0)) * resolution,
+                             costmap.getOriginY() + (shift_y + 0.5 * (shift_y > 0) - 0.5 * (shift_y < 0)) * resolution);
+
+        const long origin_i = std::lround(costmap.getOriginX() / resolution);
+        const long origin_j = std::lround(costmap.getOriginY() / resolution);
+        const int size_x = costmap.getSizeInCellsX(), size_y = costmap.getSizeInCellsY();
+        for (unsigned int i = 0; i < costmap.getSizeInCellsX(); i++)
+        {
+            for (unsigned int j = 0; j < costmap.getSizeInCellsY(); j++)
+            {
+                bool entered = (shift_x > 0 && (int)i >= size_x - shift_x) || (shift_x < 0 && (int)i < -shift_x) ||
+                               (shift_y > 0 && (int)j >= size_y - shift_y) || (shift_y < 0 && (int)j < -shift_y);
+                if (entered)
+                    costmap.setCost(i, j, worldCost(origin_i + i, origin_j + j));
+            }
+        }
+    }
+
+    void drawWorld(costmap_2d::Costmap2D &costmap)
+    {
+        const long origin_i = std::lround(costmap.getOriginX() / costmap.getResolution());
+        const long origin_j = std::lround(costmap.getOriginY() / costmap.getResolution());
+        for (unsigned int i = 0; i < costmap.getSizeInCellsX(); i++)
+        {
+            for (unsigned int j = 0; j < costmap.getSizeInCellsY(); j++)
+                costmap.setCost(i, j, worldCost(origin_i + i, origin_j + j));
+        }
+    }
+}
+
+TEST(OccupiedCellsTest, FirstUpdateReadsTheMap)
+{
+    costmap_2d::Costmap2D costmap(60, 40, 0.05, -1.5, -1.0, costmap_2d::FREE_SPACE);
+    drawWorld(costmap);
+
+    OccupiedCells occupied_cells;
+    occupied_cells.update(costmap);
+    ASSERT_TRUE(occupied_cells.getStatistics().rebuilt);
+    ASSERT_EQ(occupied_cells.getPositions(), fullScan(costmap));
+
+    // Nothing changed
+    occupied_cells.update(costmap);
+    ASSERT_FALSE(occupied_cells.getStatistics().rebuilt);
+    ASSERT_EQ(occupied_cells.getStatistics().changed_rows, 0);
+    ASSERT_EQ(occupied_cells.getPositions(), fullScan(costmap));
+}
+
+TEST(OccupiedCellsTest, FlippedCells)
+{
+    costmap_2d::Costmap2D costmap(60, 40, 0.05, -1.5, -1.0, costmap_2d::FREE_SPACE);
+    drawWorld(costmap);
+
+    OccupiedCells occupied_cells;
+    occupied_cells.update(costmap);
+
+    costmap.setCost(0, 0, costmap.getCost(0, 0) == costmap_2d::FREE_SPACE ? costmap_2d::LETHAL_OBSTACLE : costmap_2d::FREE_SPACE);
+    costmap.setCost(59, 39, costmap.getCost(59, 39) == costmap_2d::FREE_SPACE ? costmap_2d::LETHAL_OBSTACLE : costmap_2d::FREE_SPACE);
+    occupied_cells.update(costmap);
+    ASSERT_EQ(occupied_cells.getStatistics().changed_rows, 2);
+    ASSERT_EQ(occupied_cells.getStatistics().changed_cells, 2);
+    ASSERT_EQ(occupied_cells.getPositions(), fullScan(costmap));
+
+    // A cost that changes but stays occupied
+    costmap.setCost(0, 0, costmap_2d::LETHAL_OBSTACLE);
+    occupied_cells.update(costmap);
+    costmap.setCost(0, 0, costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+    occupied_cells.update(costmap);
+    ASSERT_EQ(occupied_cells.getStatistics().changed_rows, 1);
+    ASSERT_EQ(occupied_cells.getStatistics().changed_cells, 0);
+    ASSERT_EQ(occupied_cells.getPositions(), fullScan(costmap));
+
+    // Everything free, then everything occupied
+    for (unsigned int i = 0; i < costmap.getSizeInCellsX(); i++)
+    {
+        for (unsigned int j = 0; j < costmap.getSizeInCellsY(); j++)
+            costmap.setCost(i, j, costmap_2d::FREE_SPACE);
+    }
+    occupied_cells.update(costmap);
+    ASSERT_TRUE(occupied_cells.getPositions().empty());
+
+    for (unsigned int i = 0; i < costmap.getSizeInCellsX(); i++)
+    {
+        for (unsigned int j = 0; j < costmap.getSizeInCellsY(); j++)
+            costmap.setCost(i, j, costmap_2d::LETHAL_OBSTACLE);
+    }
+    occupied_cells.update(costmap);
+    ASSERT_EQ(occupied_cells.getStatistics().occupied_cells, 60 * 40);
+    ASSERT_EQ(occupied_cells.getPositions(), fullScan(costmap));
+}
+
+TEST(OccupiedCellsTest, MatchesFullScanWhileMovingAndFlipping)
+{
+    std::mt19937 generator(3);
+    std::uniform_int_distribution<int> percent(0, 99), step(-2, 2);
+
+    costmap_2d::Costmap2D costmap(60, 40, 0.05, -1.5, -1.0, costmap_2d::FREE_SPACE);
+    drawWorld(costmap);
+
+    OccupiedCells occupied_cells;
+    int num_shifts = 0, num_rebuilds = 0;
+    for (int cycle = 0; cycle < 300; cycle++)
+    {
+        int event = percent(generator);
+        if (event < 30) // The robot moved
+        {
+            moveWindow(costmap, step(generator), step(generator));
+        }
+        else if (event < 32) // Jumped further than the window
+        {
+            moveWindow(costmap, 100, 0);
+        }
+        else if (event < 34) // The map was resized
+        {
+            costmap.resizeMap(40 + percent(generator) % 30, 40, 0.05, costmap.getOriginX(), costmap.getOriginY());
+            drawWorld(costmap);
+        }
+
+        // Dynamic obstacles
+        for (int flip = 0; flip < 20; flip++)
+        {
+            unsigned int i = percent(generator) % costmap.getSizeInCellsX();
+            unsigned int j = percent(generator) % costmap.getSizeInCellsY();
+            costmap.setCost(i, j, percent(generator) % 2 == 0 ? costmap_2d::FREE_SPACE : 100);
+        }
+
+        occupied_cells.update(costmap);
+
+        // The same positions in the same order
+        ASSERT_EQ(occupied_cells.getPositions(), fullScan(costmap)) << "cycle " << cycle;
+
+        const auto &statistics = occupied_cells.getStatistics();
+        ASSERT_EQ(statistics.occupied_cells, (int)occupied_cells.getPositions().size());
+        num_rebuilds += statistics.rebuilt;
+        num_shifts += statistics.shift_x != 0 || statistics.shift_y != 0;
+    }
+
+    // All paths were taken
+    ASSERT_GT(num_shifts, 10);
+    ASSERT_GT(num_rebuilds, 2);
+}
+
+// Run all the tests
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -7,6 +7,7 @@
 
 #include <ros_tools/visuals.h> // TODO MOAI
 #include <ros_tools/convertions.h>
+#include <ros_tools/profiling.h>
 
 #include <std_msgs/Empty.h>
 
@@ -64,6 +65,18 @@ namespace local_planner
 
     ROSNavigationPlanner::~ROSNavigationPlanner()
     {
+        if (_planner)
+        {
+            _planner->printSolverStatistics();
+            _planner->printModuleTimings();
+            BENCHMARKERS.getBenchmarker("command_latency").print();
+            ALLOCATIONS.print(); // Per profiling scope (only with ros_tools built with TRACK_ALLOCATIONS)
+
+            if (CONFIG["solver_settings"]["statistics_file"].IsDefined() &&
+                !CONFIG["solver_settings"]["statistics_file"].as<std::string>().empty())
+                _planner->saveSolverStatistics(CONFIG["solver_settings"]["statistics_file"].as<std::string>());
+        }
+
         ROS_INFO_STREAM("Stopped ROSNavigation Planner");
     }
 
@@ -167,11 +180,11 @@ namespace local_planner
         double goal_angle = 0.;
 
         if (_data.reference_path.x.size() > 2)
-            goal_angle = std::atan2(_data.reference_path.y[2] - _state.get("y"), _data.reference_path.x[2] - _state.get("x"));
+            goal_angle = std::atan2(_data.reference_path.y[2] - _state.get(Layout::Var::Y), _data.reference_path.x[2] - _state.get(Layout::Var::X));
         else
-            goal_angle = std::atan2(_data.goal(1) - _state.get("y"), _data.goal(0) - _state.get("x"));
+            goal_angle = std::atan2(_data.goal(1) - _state.get(Layout::Var::Y), _data.goal(0) - _state.get(Layout::Var::X));
 
-        double angle_diff = goal_angle - _state.get("psi");
+        double angle_diff = goal_angle - _state.get(Layout::Var::PSI);
 
         if (angle_diff > M_PI)
             angle_diff -= 2 * M_PI;
@@ -195,6 +208,9 @@ namespace local_planner
     void ROSNavigationPlanner::loop(geometry_msgs::Twist &cmd_vel)
     {
 
+        auto &latency = BENCHMARKERS.getBenchmarker("command_latency");
+        latency.start();
+
         // Copy data for thread safety
         RealTimeData data = _data;
         State state = _state;
@@ -206,9 +222,9 @@ namespace local_planner
         // if (CONFIG["debug_output"].as<bool>())
         //     state.print();
 
-        auto output = _planner->solveMPC(state, data);
+        const auto &output = _planner->solveMPC(state, data);
 
-        ROS_INFO_STREAM("Success: " << output.success);
+        LOG_MARK("Success: " << output.success);
 
         geometry_msgs::Twist cmd;
         if (_enable_output && output.success)
@@ -219,17 +235,18 @@ namespace local_planner
         }
         else
         {
-            double deceleration = CONFIG["deceleration_at_infeasible"].as<double>();
+            double deceleration = CONFIG_SNAPSHOT.deceleration_at_infeasible;
             double velocity_after_braking;
             double velocity;
-            double dt = 1. / CONFIG["control_frequency"].as<double>();
+            double dt = 1. / CONFIG_SNAPSHOT.control_frequency;
 
-            velocity = _state.get("v");
+            velocity = _state.get(Layout::Var::V);
             velocity_after_braking = velocity - deceleration * dt;   // Brake with the given deceleration
             cmd_vel.linear.x = std::max(velocity_after_braking, 0.); // Don't drive backwards when braking
             cmd_vel.angular.z = 0.0;
         }
         _cmd_pub.publish(cmd);
+        latency.stop(); // Time from the start of the loop until the command is out
 
         // publishCamera();
 
@@ -238,23 +255,25 @@ namespace local_planner
             _planner->visualize(state, data);
             visualize();
         }
+
+        _planner->prepareNextIteration(data); // RTI split / pipelined: prepare the next cycle after the command is out
         // ROS_INFO_STREAM("============= End Loop =============");
     }
 
     void ROSNavigationPlanner::stateCallback(const nav_msgs::Odometry::ConstPtr &msg)
     {
         // ROS_INFO_STREAM("State callback");
-        _state.set("x", msg->pose.pose.position.x);
-        _state.set("y", msg->pose.pose.position.y);
-        _state.set("psi", RosTools::quaternionToAngle(msg->pose.pose.orientation));
-        _state.set("v", std::sqrt(std::pow(msg->twist.twist.linear.x, 2.) + std::pow(msg->twist.twist.linear.y, 2.)));
+        _state.set(Layout::Var::X, msg->pose.pose.position.x);
+        _state.set(Layout::Var::Y, msg->pose.pose.position.y);
+        _state.set(Layout::Var::PSI, RosTools::quaternionToAngle(msg->pose.pose.orientation));
+        _state.set(Layout::Var::V, std::sqrt(std::pow(msg->twist.twist.linear.x, 2.) + std::pow(msg->twist.twist.linear.y, 2.)));
 
         if (std::abs(msg->pose.pose.orientation.x) > (M_PI / 8.) || std::abs(msg->pose.pose.orientation.y) > (M_PI / 8.))
         {
             ROS_WARN_STREAM("Detected flipped robot. Resetting.");
             reset(false); // Reset without success
         }
-        // ROS_INFO_STREAM("Updated _state: x=" << _state.get("x") << ", y=" << _state.get("y") << ", psi=" << _state.get("psi") << ", v=" << _state.get("v"));
+        // ROS_INFO_STREAM("Updated _state: x=" << _state.get(Layout::Var::X) << ", y=" << _state.get(Layout::Var::Y) << ", psi=" << _state.get(Layout::Var::PSI) << ", v=" << _state.get(Layout::Var::V));
     }
 
     void ROSNavigationPlanner::goalCallback(const geometry_msgs::PoseStamped::ConstPtr &msg)
@@ -315,8 +334,8 @@ namespace local_planner
         auto &publisher = VISUALS.getPublisher("angle");
         auto &line = publisher.getNewLine();
 
-        line.addLine(Eigen::Vector2d(_state.get("x"), _state.get("y")),
-                     Eigen::Vector2d(_state.get("x") + 1.0 * std::cos(_state.get("psi")), _state.get("y") + 1.0 * std::sin(_state.get("psi"))));
+        line.addLine(Eigen::Vector2d(_state.get(Layout::Var::X), _state.get(Layout::Var::Y)),
+                     Eigen::Vector2d(_state.get(Layout::Var::X) + 1.0 * std::cos(_state.get(Layout::Var::PSI)), _state.get(Layout::Var::Y) + 1.0 * std::sin(_state.get(Layout::Var::PSI))));
         publisher.publish();
     }
 
@@ -332,7 +351,7 @@ namespace local_planner
         _planner->reset(_state, _data, success);
         _data.costmap = costmap_;
 
-        ros::Duration(1.0 / CONFIG["control_frequency"].as<double>()).sleep();
+        ros::Duration(1.0 / CONFIG_SNAPSHOT.control_frequency).sleep();
 
         done_ = false;
         _rotate_to_goal = false;
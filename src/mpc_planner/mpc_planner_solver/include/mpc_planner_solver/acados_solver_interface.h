@@ -2,8 +2,14 @@
 #define ACADOS_SOLVER_INTERFACE_H
 
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <vector>
 
 #include <mpc_planner_solver/state.h>
+#include <mpc_planner_solver/mpc_planner_layout.h>
+#include <mpc_planner_solver/solver_definition.h>
+#include <mpc_planner_solver/solver_statistics.h>
 
 #include "acados/utils/print.h"
 #include "acados/utils/math.h"
@@ -48,6 +54,14 @@
 
 namespace MPCPlanner
 {
+    /** @brief Where the iterate and multipliers of a solve came from */
+    enum class WarmStartType
+    {
+        COLD = 0, // Reset QP memory (multipliers are zero)
+        PREVIOUS, // This solver's own previous cycle
+        COPIED    // Copied from another solver with copySolverMemory()
+    };
+
     struct AcadosParameters
     {
         double xinit[NX];                      // Initial state
@@ -55,7 +69,11 @@ namespace MPCPlanner
 
         double all_parameters[SOLVER_NP * SOLVER_N]; // SOLVER_NP parameters for all stages
 
-        double solver_timeout{0.}; // Not functional!
+        // Range of parameters per stage that changed since the last upload: [dirty_begin, dirty_end)
+        int dirty_begin[SOLVER_N];
+        int dirty_end[SOLVER_N];
+
+        double solver_timeout{0.}; // Time available for the next solve [s], enforced as a deadline on the SQP and QP iterations
 
         double *getU0() { return x0; } // Note: should only read the first isolver_nput from this!
 
@@ -71,6 +89,57 @@ namespace MPCPlanner
 
             for (int i = 0; i < SOLVER_NP * SOLVER_N; i++)
                 all_parameters[i] = 0.;
+
+            markAllDirty();
+        }
+
+        /** @brief Set a parameter of stage k. Only marks the stage for upload if the value changed */
+        void set(int k, int index, double value)
+        {
+            double &parameter = all_parameters[k * SOLVER_NP + index];
+            if (parameter == value)
+                return;
+
+            parameter = value;
+            dirty_begin[k] = std::min(dirty_begin[k], index);
+            dirty_end[k] = std::max(dirty_end[k], index + 1);
+        }
+
+        /** @brief Set count consecutive parameters of stage k, starting at index. Only marks the changed range for upload */
+        void setBlock(int k, int index, const double *values, int count)
+        {
+            double *parameters = &all_parameters[k * SOLVER_NP + index];
+
+            int first = 0;
+            while (first < count && parameters[first] == values[first])
+                first++;
+            if (first == count)
+                return;
+
+            int last = count;
+            while (parameters[last - 1] == values[last - 1])
+                last--;
+
+            std::copy(values + first, values + last, parameters + first);
+            dirty_begin[k] = std::min(dirty_begin[k], index + first);
+            dirty_end[k] = std::max(dirty_end[k], index + last);
+        }
+
+        bool isDirty(int k) const { return dirty_begin[k] < dirty_end[k]; }
+
+        void markClean(int k)
+        {
+            dirty_begin[k] = SOLVER_NP;
+            dirty_end[k] = 0;
+        }
+
+        void markAllDirty()
+        {
+            for (int k = 0; k < SOLVER_N; k++)
+            {
+                dirty_begin[k] = 0;
+                dirty_end[k] = SOLVER_NP;
+            }
         }
 
         void printParameters(YAML::Node &parameter_map)
@@ -100,11 +169,22 @@ namespace MPCPlanner
             double kkt_norm_inf;
             double elapsed_time;
             int sqp_iter;
+            int qp_iter{0}; // QP iterations summed over all SQP iterations
             double nlp_res;
             double solvetime;
 
             int qp_status;
 
+            double preparation_time{0.};   // RTI preparation phase (linearization and condensing) [s]
+            double feedback_time{0.};      // RTI feedback phase (QP solve after the initial state is known) [s]
+            double linearization_time{0.}; // Summed over all SQP iterations [s]
+            double qp_time{0.};            // Summed over all SQP iterations [s]
+
+            WarmStartType warm_start{WarmStartType::COLD};
+
+            int uploaded_stages{0};   // Stages with parameters sent to acados in this cycle
+            size_t uploaded_bytes{0}; // Parameter data sent to acados in this cycle
+
             double pobj{0.}; // TODO
 
             AcadosInfo()
@@ -116,9 +196,17 @@ namespace MPCPlanner
             {
                 LOG_HEADER("Solver Info");
                 LOG_VALUE("SQP iterations", sqp_iter);
+                LOG_VALUE("QP iterations", qp_iter);
+                LOG_VALUE("Warm start", (int)warm_start);
                 LOG_VALUE("Minimum time for solve [ms]", min_time * 1000);
                 LOG_VALUE("KKT", kkt_norm_inf);
                 LOG_VALUE("Solve Time [ms]", solvetime * 1000.);
+                LOG_VALUE("Preparation Time [ms]", preparation_time * 1000.);
+                LOG_VALUE("Feedback Time [ms]", feedback_time * 1000.);
+                LOG_VALUE("Linearization Time [ms]", linearization_time * 1000.);
+                LOG_VALUE("QP Time [ms]", qp_time * 1000.);
+                LOG_VALUE("Uploaded parameter stages", uploaded_stages);
+                LOG_VALUE("Uploaded parameter bytes", uploaded_bytes);
                 LOG_VALUE("NLP Residuals", nlp_res);
                 Solver_acados_print_stats(acados_ocp_capsule);
             }
@@ -158,6 +246,56 @@ namespace MPCPlanner
 
         int _exit_code_one_iter{-1};
 
+        std::shared_ptr<const SolverDefinition> _definition;
+        double _creation_time{0.}; // [s]
+
+        bool _is_rti{true};
+        bool _rti_split{false};         // Run the RTI preparation phase ahead of the feedback phase
+        bool _is_prepared{false};       // The preparation phase ran for the next solve
+        bool _precompute_needed{false}; // Dimensions or time grid changed since the last precompute
+        int _rti_phase{-1};
+
+        int _parameter_indices[SOLVER_NP]; // 0, ..., SOLVER_NP - 1 for sparse parameter updates
+
+        WarmStartType _warm_start{WarmStartType::COLD}; // Type of the warm start that the next solve uses
+        std::vector<double> _iterate_buffer;             // Scratch space to copy the iterate between solvers
+
+        double _time_steps[SOLVER_N];      // Duration of each stage [s]
+        double _stage_times[SOLVER_N + 1]; // Time at the start of each stage (and the end of the horizon) [s]
+        bool _uniform_time_grid{true};
+
+        void loadTimeGrid();
+        void computeStageTimes();
+        void setRtiPhase(int rti_phase);
+        void uploadParameters();
+
+        // Deadline of the current solve
+        std::chrono::steady_clock::time_point _deadline;
+        int _qp_iter_max{50};             // As generated (solver_settings.acados.qp_iter_max)
+        int _qp_iter_limit{50};           // Current QP iteration limit to make the deadline
+        double _qp_iteration_time{0.};    // Estimated time per QP iteration [s]
+        double _linearization_time{0.};   // Estimated time per SQP iteration besides the QP [s]
+
+        double getRemainingTime() const;
+        bool limitToDeadline(double remaining_time); // False if not even one QP iteration fits
+        int skipSolve();
+
+        // Final stage of a shifted warmstart
+        enum class TerminalExtrapolation
+        {
+            HOLD,   // Repeat the final state
+            ROLLOUT // Integrate the final state over one more step with the final inputs
+        };
+        TerminalExtrapolation _terminal_extrapolation{TerminalExtrapolation::HOLD};
+
+        void copyOutputToWarmstart(int k_output, int k);
+        void extrapolateTerminalStage();
+
+        SolverStatistics _statistics;
+        uint64_t _num_solves{0};
+
+        void recordStatistics(int exit_code, double wall_time);
+
     public:
         int _solver_id;
 
@@ -175,36 +313,90 @@ namespace MPCPlanner
         YAML::Node _config, _parameter_map, _model_map;
 
         int _num_iterations;
+        int _iteration_limit{0}; // Cap on _num_iterations for the next solves (0 = no cap)
 
     public:
         Solver(int solver_id = 0);
         ~Solver();
 
-        /** @brief Copy data from another solver. Does not copy solver generic parameters like the horizon N*/
+        /** @brief Time to construct this solver, including the acados capsule [s] */
+        double getCreationTime() const { return _creation_time; }
+
+        /** @brief Copy data from another solver. Does not copy solver generic parameters like the horizon N.
+         * @note Keeps the iterate and multipliers of this solver (see copySolverMemory() and resetSolverMemory()) */
         Solver &operator=(const Solver &rhs);
 
+        /** @brief Warm start from another solver: primal iterate, multipliers and the QP solution that HPIPM warm starts from */
+        void copySolverMemory(const Solver &other);
+
+        /** @brief Drop the multipliers and QP memory so that the next solve starts cold */
+        void resetSolverMemory();
+        WarmStartType getWarmStartType() const { return _warm_start; }
+
         void reset();
 
+        /** @brief Exit code when the deadline passed or left no time for a single linearization and QP iteration */
+        static constexpr int DEADLINE_SKIPPED = -10;
+
+        /** @brief Solve within _params.solver_timeout. Returns 1 on success and ACADOS_TIMEOUT if the deadline interrupted
+         * the iterations (the last completed iterate is returned, see hasUsableSolution()). Returns DEADLINE_SKIPPED
+         * without solving if not even one iteration fits (the output is then the loaded initial guess) */
         int solve();
+        bool hasUsableSolution(int exit_code) const { return exit_code == 1 || exit_code == ACADOS_TIMEOUT; }
+
+        /** @brief Cap the SQP iterations of the next solves (e.g., by the CycleScheduler), 0 removes the cap */
+        void setIterationLimit(int iterations) { _iteration_limit = iterations; }
+        int getMaxIterations() const { return _num_iterations; } // As generated (solver_settings.acados.iterations)
+
+        /** @brief Timing, iterations and exit codes of the last solves */
+        const SolverStatistics &getStatistics() const { return _statistics; }
 
         // One iteration a time interface
         void initializeOneIteration();
         int solveOneIteration();
         int completeOneIteration();
 
+        /** @brief RTI preparation phase with the loaded warmstart and parameters. The next solve() only runs the feedback phase */
+        void prepare();
+        bool isPrepared() const { return _is_prepared; }
+        void discardPreparation() { _is_prepared = false; } // The next solve() runs both RTI phases
+        bool isRtiSplit() const { return _rti_split; }
+
+        // TIME GRID //
+        /** @brief Switch to new stage durations (SOLVER_N values). The horizon length N does not change */
+        void setTimeSteps(const double *time_steps);
+        void setUniformTimeSteps(double time_step);
+        const double *getTimeSteps() const { return _time_steps; }
+        double getTimeStep(int k) const { return _time_steps[std::min(k, N - 1)]; }
+        double getStageTime(int k) const { return _stage_times[k]; }
+        /** @brief Time in the obstacle predictions (step i at i * dt) that stage k is compared with */
+        double getPredictionTime(int k) const { return std::max(_stage_times[k] - dt, 0.); }
+        bool isTimeGridUniform() const { return _uniform_time_grid; }
+
         // PARAMETERS //
         bool hasParameter(std::string &&parameter);
         void setParameter(int k, std::string &&parameter, double value);
         void setParameter(int k, std::string &parameter, double value);
         double getParameter(int k, std::string &&parameter);
 
+        /** @brief Typed access with an index from Layout::Param */
+        void setParameter(int k, int parameter_index, double value) { _params.set(k, parameter_index, value); }
+        /** @brief Set count consecutive parameters of stage k, starting at parameter_index */
+        void setParameterBlock(int k, int parameter_index, const double *values, int count) { _params.setBlock(k, parameter_index, values, count); }
+        double getParameter(int k, int parameter_index) const { return _params.all_parameters[k * SOLVER_NP + parameter_index]; }
+
         // XINIT //
         void setXinit(std::string &&state_name, double value);
+        void setXinit(int var_index, double value) { _params.xinit[Layout::stateIndex(var_index)] = value; }
         void setXinit(const State &state);
 
         // WARMSTART //
         void setEgoPrediction(unsigned int k, std::string &&var_name, double value); // Modify the initial guess
         double getEgoPrediction(unsigned int k, std::string &&var_name);             // Get the initial guess
+
+        /** @brief Typed access with an index from Layout::Var */
+        void setEgoPrediction(unsigned int k, int var_index, double value) { _params.x0[k * Layout::NUM_VARIABLES + var_index] = value; }
+        double getEgoPrediction(unsigned int k, int var_index) const { return _params.x0[k * Layout::NUM_VARIABLES + var_index]; }
         void setEgoPredictionPosition(unsigned int k, const Eigen::Vector2d &value); // (same for positions)
         Eigen::Vector2d getEgoPredictionPosition(unsigned int k);
 
@@ -215,6 +407,13 @@ namespace MPCPlanner
 
         // OUTPUT //
         double getOutput(int k, std::string &&state_name) const;
+        double getOutput(int k, int var_index) const
+        {
+            if (Layout::isState(var_index))
+                return _output.xtraj[k * Layout::NUM_STATES + Layout::stateIndex(var_index)];
+            else
+                return _output.utraj[k * Layout::NUM_INPUTS + var_index];
+        }
 
         // DEBUG //
         std::string explainExitFlag(int exitflag) const;
@@ -0,0 +1,96 @@
+#ifndef MPC_PLANNER_CYCLE_SCHEDULER_H
+#define MPC_PLANNER_CYCLE_SCHEDULER_H
+
+#include <array>
+#include <chrono>
+
+namespace MPCPlanner
+{
+    /**
+     * @brief Owns the deadline of a planning cycle (one control period after the planning start). Times the phases of
+     * the cycle, gives the solver the time that is left after the expected post-processing and adapts the cap on the
+     * SQP iterations to the measured solve times
+     */
+    class CycleScheduler
+    {
+    public:
+        typedef std::chrono::steady_clock::time_point Deadline;
+
+        enum class Phase
+        {
+            DATA_PREPARATION = 0, // Data checks and the warmstart
+            MODULE_UPDATE,
+            PARAMETERS,
+            SOLVE,
+            POST_PROCESSING
+        };
+        static constexpr int NUM_PHASES = 5;
+
+        struct Settings
+        {
+            double control_period{0.05}; // [s]
+            double margin{0.003};        // Kept free at the end of the cycle (e.g., to publish the command) [s]
+
+            bool adapt_iterations{false};
+            double target_utilization{0.8}; // Fraction of the solver budget that the solves should use
+            double gain{0.5};               // Change of the iteration cap per unit of utilization error (times the max)
+        };
+
+    public:
+        /** @param max_iterations The SQP iterations of the generated solver */
+        CycleScheduler(const Settings &settings, int max_iterations);
+
+        /** @brief Start a cycle in the data preparation phase, the deadline is one control period after planning_start_time */
+        void startCycle(std::chrono::system_clock::time_point planning_start_time);
+
+        /** @brief End the current phase and start the given phase */
+        void startPhase(Phase phase);
+
+        /** @brief End the last phase and record whether the deadline was missed */
+        void endCycle();
+
+        Deadline getDeadline() const { return _deadline; }
+
+        /** @brief Deadline for the solver(s): the cycle deadline minus the expected post-processing and the margin */
+        Deadline getSolverDeadline() const;
+
+        /** @brief Time from now until the solver deadline [s] */
+        double getSolverBudget() const;
+
+        /** @brief SQP iterations for the next solve (the generated number if not adapted) */
+        int getIterationLimit() const;
+
+        /** @brief Feedback from a solve that started with the current solver budget (time of the SOLVE phase) */
+        void onSolved();
+
+        int numCycles() const { return _num_cycles; }
+        int numDeadlineMisses() const { return _num_misses; }
+
+        /** @brief Average and maximum time of each phase, the deadline misses and the iteration cap */
+        void print() const;
+
+    private:
+        Settings _settings;
+        int _max_iterations;
+        double _iteration_cap; // Continuous state of the iteration controller
+
+        Deadline _deadline;
+        Phase _phase{Phase::DATA_PREPARATION};
+        std::chrono::steady_clock::time_point _phase_start;
+        bool _running{false};
+
+        double _solve_budget{0.};            // Solver budget at the start of the last solve [s]
+        double _post_processing_time{0.};    // Estimated post-processing time [s]
+        std::array<double, NUM_PHASES> _last{}; // Duration of each phase in the current cycle [s]
+
+        std::array<double, NUM_PHASES> _total{};
+        std::array<double, NUM_PHASES> _max{};
+        int _num_cycles{0};
+        int _num_misses{0};
+        double _max_overrun{0.}; // [s]
+
+        void endPhase();
+    };
+}
+
+#endif // MPC_PLANNER_CYCLE_SCHEDULER_H
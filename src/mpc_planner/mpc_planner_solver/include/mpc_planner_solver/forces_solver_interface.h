@@ -2,9 +2,13 @@
 #define __MPC_PLANNER_SOLVER_FORCES_H__
 
 #include <mpc_planner_solver/state.h>
+#include <mpc_planner_solver/mpc_planner_layout.h>
+#include <mpc_planner_solver/solver_definition.h>
+#include <mpc_planner_solver/solver_statistics.h>
 
 #include <mpc_planner_util/load_yaml.hpp>
 
+#include <algorithm>
 #include <memory>
 
 #include <Solver.h>
@@ -39,6 +43,11 @@ namespace MPCPlanner
 		char *_solver_memory;
 		Solver_mem *_solver_memory_handle;
 
+		SolverStatistics _statistics;
+		uint64_t _num_solves{0};
+
+		double _creation_time{0.}; // [s]
+
 	public:
 		int _solver_id;
 
@@ -61,14 +70,28 @@ namespace MPCPlanner
 		void reset();
 		~Solver();
 
+		/** @brief Time to construct this solver [s] */
+		double getCreationTime() const { return _creation_time; }
+
 		/** @brief Copy data from another solver. Does not copy solver generic parameters like the horizon N*/
 		Solver &operator=(const Solver &rhs);
 
 		char *getSolverMemory() const;
 		void copySolverMemory(const Solver &other);
+		void resetSolverMemory() {} // FORCES initializes every solve (solver_settings.forces.init)
+		bool hasUsableSolution(int exit_code) const { return exit_code == 1; }
+
+		/** @note The FORCES solver sets its iterations at generation */
+		void setIterationLimit(int iterations) { (void)iterations; }
+		int getMaxIterations() const { return 1; }
+
+		/** @brief Timing and iterations of the last solves */
+		const SolverStatistics &getStatistics() const { return _statistics; }
 
 		void setEgoPrediction(unsigned int k, std::string &&var_name, double value);
 		double getEgoPrediction(unsigned int k, std::string &&var_name);
+		void setEgoPrediction(unsigned int k, int var_index, double value) { _params.x0[k * Layout::NUM_VARIABLES + var_index] = value; }
+		double getEgoPrediction(unsigned int k, int var_index) const { return _params.x0[k * Layout::NUM_VARIABLES + var_index]; }
 		void setEgoPredictionPosition(unsigned int k, const Eigen::Vector2d &value);
 		Eigen::Vector2d getEgoPredictionPosition(unsigned int k);
 
@@ -77,8 +100,12 @@ namespace MPCPlanner
 		void setParameter(int k, std::string &&parameter, double value);
 		void setParameter(int k, std::string &parameter, double value);
 		double getParameter(int k, std::string &&parameter);
+		void setParameter(int k, int parameter_index, double value) { _params.all_parameters[k * Layout::NUM_PARAMETERS + parameter_index] = value; }
+		void setParameterBlock(int k, int parameter_index, const double *values, int count) { std::copy(values, values + count, &_params.all_parameters[k * Layout::NUM_PARAMETERS + parameter_index]); }
+		double getParameter(int k, int parameter_index) const { return _params.all_parameters[k * Layout::NUM_PARAMETERS + parameter_index]; }
 
 		void setXinit(std::string &&state_name, double value);
+		void setXinit(int var_index, double value) { _params.xinit[Layout::stateIndex(var_index)] = value; }
 		void setXinit(const State &state);
 
 		void initializeWithState(const State &initial_state);
@@ -96,7 +123,21 @@ namespace MPCPlanner
 		int solveOneIteration();
 		int completeOneIteration();
 
+		// The RTI preparation / feedback split is not available for Forces Pro
+		void prepare() {}
+		bool isPrepared() const { return false; }
+		void discardPreparation() {}
+		bool isRtiSplit() const { return false; }
+
+		/** @note The FORCES solver has a fixed, uniform time grid */
+		double getTimeStep(int k) const { (void)k; return dt; }
+		double getStageTime(int k) const { return (double)k * dt; }
+		/** @brief Time in the obstacle predictions (step i at i * dt) that stage k is compared with */
+		double getPredictionTime(int k) const { return std::max(getStageTime(k) - dt, 0.); }
+		bool isTimeGridUniform() const { return true; }
+
 		double getOutput(int k, std::string &&state_name) const;
+		double getOutput(int k, int var_index) const;
 
 		// Debugging utilities
 		std::string explainExitFlag(int exitflag);
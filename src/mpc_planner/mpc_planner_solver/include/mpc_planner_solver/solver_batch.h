@@ -0,0 +1,70 @@
+#ifndef MPC_PLANNER_SOLVER_BATCH_H
+#define MPC_PLANNER_SOLVER_BATCH_H
+
+#include <mpc_planner_solver/solver_interface.h>
+#include <mpc_planner_solver/worker_pool.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace MPCPlanner
+{
+    /**
+     * @brief Solves M problems of the same generated solver in parallel on a WorkerPool, with one shared deadline for
+     * all problems
+     */
+    class SolverBatch
+    {
+    public:
+        typedef std::chrono::steady_clock::time_point Deadline;
+
+        enum class Policy
+        {
+            FIRST_FEASIBLE, // Problems that did not start are skipped as soon as one problem is feasible
+            BEST_OBJECTIVE  // Solve all problems that start before the deadline, select the lowest feasible objective
+        };
+
+        struct Result
+        {
+            int exit_code{-1};
+            bool success{false};
+            bool solved{false}; // False if setup skipped the problem, the deadline passed or another problem won
+            double objective{std::numeric_limits<double>::infinity()};
+            double solve_time{0.}; // [s]
+        };
+
+        /** @brief Loads problem i into its solver (constraints, parameters, warmstart). Return false to skip the problem */
+        typedef std::function<bool(int problem, Solver &solver)> SetupFunction;
+
+        /** @brief Solves problem i, returns the exit code (default: Solver::solve()) */
+        typedef std::function<int(int problem, Solver &solver)> SolveFunction;
+
+    public:
+        SolverBatch(int num_workers);
+
+        /** @brief Solve all problems before the deadline. Returns the selected problem or -1 if none is feasible */
+        int solve(std::vector<std::shared_ptr<Solver>> &solvers, const SetupFunction &setup, Deadline deadline,
+                  Policy policy, const SolveFunction &solve_function = nullptr);
+
+        const std::vector<Result> &getResults() const { return _results; }
+        const Result &getResult(int problem) const { return _results[problem]; }
+
+        int numWorkers() const { return _workers.numWorkers(); }
+
+        /** @brief Construct one solver per id concurrently (acados capsule creation dominates the startup time) and
+         * log the creation time of each */
+        static std::vector<std::shared_ptr<Solver>> createSolvers(const std::vector<int> &solver_ids);
+
+    private:
+        WorkerPool _workers;
+
+        std::vector<Result> _results;
+        std::atomic<int> _first_feasible{-1};
+    };
+}
+
+#endif // MPC_PLANNER_SOLVER_BATCH_H
@@ -0,0 +1,47 @@
+#ifndef MPC_PLANNER_SOLVER_DEFINITION_H
+#define MPC_PLANNER_SOLVER_DEFINITION_H
+
+#include <mpc_planner_solver/mpc_planner_layout.h>
+
+#include <yaml-cpp/yaml.h>
+
+#include <array>
+#include <memory>
+
+namespace MPCPlanner
+{
+    /**
+     * @brief Everything a solver reads at construction: the generated maps and the solver options of the configuration.
+     * Loaded once and shared by all solvers, so that solvers can be constructed concurrently without touching CONFIG
+     */
+    struct SolverDefinition
+    {
+        // Generated with the solver
+        YAML::Node solver_settings, parameter_map, model_map;
+
+        double dt{0.}; // integrator_step
+
+        // solver_settings.acados
+        int num_iterations{1};
+        bool is_rti{true};
+        int qp_iter_max{50};
+        bool rti_split{false};
+        bool set_warm_start_first_qp{false}; // Keep the generated option if not configured
+        bool warm_start_first_qp{false};
+
+        std::array<double, Layout::N> time_steps; // Duration of each stage [s]
+        bool uniform_time_grid{true};
+
+        bool shift_terminal_rollout{false}; // shift_terminal_extrapolation: "rollout"
+
+        double load_time{0.}; // [s]
+
+        /** @brief The definition, loaded on first use from the generated files and CONFIG (thread-safe) */
+        static std::shared_ptr<const SolverDefinition> get();
+
+    private:
+        void load();
+    };
+}
+
+#endif // MPC_PLANNER_SOLVER_DEFINITION_H
@@ -0,0 +1,88 @@
+#ifndef MPC_PLANNER_SOLVER_STATISTICS_H
+#define MPC_PLANNER_SOLVER_STATISTICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+namespace MPCPlanner
+{
+    /** @brief Statistics of one solve */
+    struct SolveRecord
+    {
+        uint64_t cycle{0};
+        int solver_id{0};
+
+        double wall_time{0.}; // Around Solver::solve() [s]
+        double time_tot{0.};  // acados time_tot, summed over the iterations [s]
+        double time_lin{0.};  // acados linearization time [s]
+        double time_qp{0.};   // acados QP time [s]
+
+        int sqp_iter{0};
+        int qp_iter{0};
+        int exit_code{-1};
+        int warm_start{0}; // WarmStartType
+    };
+
+    /**
+     * @brief Ring buffer of the last solves of one solver. The solver writes, any thread may read without locks.
+     * @note Each slot is a sequence lock: readers skip records that are being overwritten
+     */
+    class SolverStatistics
+    {
+    public:
+        static constexpr int CAPACITY = 1024;
+
+        enum class Field
+        {
+            WALL_TIME = 0,
+            TIME_TOT,
+            TIME_LIN,
+            TIME_QP,
+            SQP_ITER,
+            QP_ITER
+        };
+
+        struct Percentiles
+        {
+            double p50{0.};
+            double p95{0.};
+            double p99{0.};
+            int samples{0};
+        };
+
+    public:
+        /** @brief Add the record of a solve. Only one thread (the one solving) may write */
+        void record(const SolveRecord &record);
+
+        /** @brief Percentiles of a field over the last window solves (at most CAPACITY) */
+        Percentiles getPercentiles(Field field, int window = CAPACITY) const;
+
+        /** @brief The last window solves, oldest first */
+        std::vector<SolveRecord> getRecords(int window = CAPACITY) const;
+
+        uint64_t numRecorded() const { return _num_recorded.load(std::memory_order_acquire); }
+
+        void print(int window = CAPACITY) const;
+        void dump(std::ostream &out, int window = CAPACITY) const; // CSV
+
+    private:
+        static_assert(std::is_trivially_copyable<SolveRecord>::value, "Records are copied word by word");
+        static constexpr int WORDS = (sizeof(SolveRecord) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        struct Slot
+        {
+            std::atomic<uint64_t> sequence{0}; // Odd while being written
+            std::atomic<uint64_t> words[WORDS];
+        };
+
+        Slot _slots[CAPACITY];
+        std::atomic<uint64_t> _num_recorded{0};
+
+        bool read(uint64_t index, SolveRecord &record) const;
+    };
+}
+
+#endif // MPC_PLANNER_SOLVER_STATISTICS_H
@@ -1,11 +1,11 @@
 #ifndef STATE_H
 #define STATE_H
 
-#include <mpc_planner_util/load_yaml.hpp>
+#include <mpc_planner_solver/mpc_planner_layout.h>
 
 #include <Eigen/Dense>
 
-#include <vector>
+#include <array>
 #include <string>
 
 namespace MPCPlanner
@@ -17,17 +17,18 @@ namespace MPCPlanner
         void initialize();
 
         double get(std::string &&var_name) const;
+        double get(const std::string &var_name) const;
+        double get(int var_index) const { return _state[Layout::stateIndex(var_index)]; } // Index from Layout::Var
         Eigen::Vector2d getPos() const;
+        const double *data() const { return _state.data(); } // Ordered as xinit / xtraj
 
         void set(std::string &&var_name, double value);
+        void set(int var_index, double value) { _state[Layout::stateIndex(var_index)] = value; }
         void print() const;
 
     private:
-        std::vector<double> _state;
-        YAML::Node _config, _model_map;
-
-        int _nu;
+        std::array<double, Layout::NUM_STATES> _state;
     };
 }
 
-#endif // STATE_H
\ No newline at end of file
+#endif // STATE_H
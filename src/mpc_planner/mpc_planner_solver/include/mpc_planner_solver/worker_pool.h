@@ -0,0 +1,46 @@
+#ifndef MPC_PLANNER_WORKER_POOL_H
+#define MPC_PLANNER_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MPCPlanner
+{
+    /**
+     * @brief A fixed set of worker threads that stay alive between jobs. A job runs a number of tasks on the workers
+     * and returns once all tasks are done (used by SolverBatch and to split per-stage work)
+     */
+    class WorkerPool
+    {
+    public:
+        WorkerPool(int num_workers);
+        ~WorkerPool();
+
+        /** @brief Run task(i) for i = 0, ..., num_tasks - 1 on the workers and wait until all tasks are done */
+        void run(int num_tasks, const std::function<void(int)> &task);
+
+        int numWorkers() const { return (int)_workers.size(); }
+
+    private:
+        std::vector<std::thread> _workers;
+
+        std::mutex _mutex;
+        std::condition_variable _start_cv, _done_cv;
+        bool _stop{false};
+        int _generation{0};
+        int _finished_workers{0};
+
+        // The current job
+        const std::function<void(int)> *_task{nullptr};
+        int _num_tasks{0};
+        std::atomic<int> _next_task{0};
+
+        void workerLoop();
+    };
+}
+
+#endif // MPC_PLANNER_WORKER_POOL_H
@@ -1,33 +1,80 @@
 #include <mpc_planner_solver/acados_solver_interface.h>
 
+#include "hpipm/include/hpipm_d_ocp_qp_sol.h"
+
 #include <mpc_planner_util/parameters.h>
 
 #include <ros_tools/profiling.h>
 
+#include <numeric>
+#include <stdexcept>
+
 namespace MPCPlanner
 {
+    namespace
+    {
+        // Unknown names are programming errors (e.g., a typo), do not read or write next to the data
+        int checkedVarIndex(const std::string &name)
+        {
+            int index = Layout::varIndex(name);
+            if (index < 0)
+                throw std::out_of_range("Variable \"" + name + "\" is not in the solver layout");
+            return index;
+        }
+
+        int checkedParamIndex(const std::string &name)
+        {
+            int index = Layout::paramIndex(name);
+            if (index < 0)
+                throw std::out_of_range("Parameter \"" + name + "\" is not in the solver layout");
+            return index;
+        }
+    }
+
+    // Iterate fields that are copied between solvers
+    static const char *ITERATE_FIELDS[] = {"x", "u", "s", "z", "pi", "lam"};
+
+    static_assert(Layout::NUM_STATES == NX && Layout::NUM_INPUTS == NU && Layout::NUM_PARAMETERS == SOLVER_NP && Layout::N == SOLVER_N,
+                  "The generated layout does not match the generated acados solver. Please regenerate the solver.");
+
     Solver::Solver(int solver_id)
     {
+        auto creation_start = std::chrono::steady_clock::now();
         _solver_id = solver_id;
 
-        loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "solver_settings"), _config);
-        loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "parameter_map"), _parameter_map);
-        loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "model_map"), _model_map);
+        // Parsed once for all solvers. The maps are cloned, YAML nodes are not safe to share between threads
+        _definition = SolverDefinition::get();
+        _config = YAML::Clone(_definition->solver_settings);
+        _parameter_map = YAML::Clone(_definition->parameter_map);
+        _model_map = YAML::Clone(_definition->model_map);
 
         _acados_ocp_capsule = Solver_acados_create_capsule();
 
         // there is an opportunity to change the number of shooting intervals in C without new code generation
         N = SOLVER_N;
-        nu = _config["nu"].as<unsigned int>();
-        nx = _config["nx"].as<unsigned int>();
-        nvar = _config["nvar"].as<unsigned int>();
-        npar = _config["npar"].as<unsigned int>();
-        dt = CONFIG["integrator_step"].as<double>();
+        nu = Layout::NUM_INPUTS;
+        nx = Layout::NUM_STATES;
+        nvar = Layout::NUM_VARIABLES;
+        npar = Layout::NUM_PARAMETERS;
+        dt = _definition->dt;
+
+        _num_iterations = _definition->num_iterations;
+
+        for (int i = 0; i < SOLVER_NP; i++)
+            _parameter_indices[i] = i;
 
-        _num_iterations = CONFIG["solver_settings"]["acados"]["iterations"].as<int>();
+        _is_rti = _definition->is_rti;
+        _qp_iter_max = _definition->qp_iter_max;
+        _qp_iter_limit = _qp_iter_max;
+        _rti_split = _definition->rti_split;
 
-        // allocate the array and fill it accordingly
-        double *new_time_steps = NULL;
+        if (_definition->shift_terminal_rollout)
+            _terminal_extrapolation = TerminalExtrapolation::ROLLOUT;
+
+        loadTimeGrid();
+
+        // NULL keeps the generated (uniform) time steps
+        double *new_time_steps = _uniform_time_grid ? NULL : _time_steps;
         int status = Solver_acados_create_with_discretization(_acados_ocp_capsule, N, new_time_steps);
 
         if (status)
@@ -43,7 +90,68 @@ namespace MPCPlanner
         _nlp_solver = Solver_acados_get_nlp_solver(_acados_ocp_capsule);
         _nlp_opts = Solver_acados_get_nlp_opts(_acados_ocp_capsule);
 
+        // Let the first QP of each solve use the multipliers of the previous solve (HPIPM otherwise starts cold)
+        if (_definition->set_warm_start_first_qp)
+        {
+            bool warm_start_first_qp = _definition->warm_start_first_qp;
+            ocp_nlp_solver_opts_set(_nlp_config, _nlp_opts, "warm_start_first_qp", &warm_start_first_qp);
+        }
+
+        if (!_is_rti)
+        {
+            ocp_nlp_timeout_heuristic_t timeout_heuristic = MAX_CALL; // Assume the slowest SQP iteration so far
+            ocp_nlp_solver_opts_set(_nlp_config, _nlp_opts, "timeout_heuristic", &timeout_heuristic);
+        }
+
+        size_t iterate_size = 0;
+        for (const char *field : ITERATE_FIELDS)
+            iterate_size = std::max(iterate_size, (size_t)ocp_nlp_dims_get_total_from_attr(_nlp_config, _nlp_dims, field));
+        _iterate_buffer.resize(iterate_size);
+
         reset();
+
+        _creation_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - creation_start).count();
+    }
+
+    void Solver::loadTimeGrid()
+    {
+        std::copy_n(_definition->time_steps.data(), N, _time_steps);
+        _uniform_time_grid = _definition->uniform_time_grid;
+
+        computeStageTimes();
+    }
+
+    void Solver::computeStageTimes()
+    {
+        _stage_times[0] = 0.;
+        for (int k = 0; k < N; k++)
+            _stage_times[k + 1] = _stage_times[k] + _time_steps[k];
+    }
+
+    void Solver::setTimeSteps(const double *time_steps)
+    {
+        if (std::equal(time_steps, time_steps + N, _time_steps))
+            return;
+
+        std::copy(time_steps, time_steps + N, _time_steps);
+        _uniform_time_grid = std::all_of(_time_steps, _time_steps + N, [&](double step)
+                                         { return step == _time_steps[0]; });
+        computeStageTimes();
+
+        int status = Solver_acados_update_time_steps(_acados_ocp_capsule, N, _time_steps);
+        if (status)
+            LOG_WARN("Solver_acados_update_time_steps() returned status " << status);
+
+        // The QP structure depends on the time steps, a prepared QP is outdated
+        _precompute_needed = true;
+        _is_prepared = false;
+    }
+
+    void Solver::setUniformTimeSteps(double time_step)
+    {
+        double time_steps[SOLVER_N];
+        std::fill(time_steps, time_steps + SOLVER_N, time_step);
+        setTimeSteps(time_steps);
     }
 
     Solver::~Solver()
@@ -65,7 +173,9 @@ namespace MPCPlanner
     Solver &Solver::operator=(const Solver &rhs)
     {
         _params = rhs._params;
-        ocp_nlp_solver_reset_qp_memory(_nlp_solver, _nlp_in, _nlp_out);
+        _params.markAllDirty(); // Our acados memory holds different parameters than rhs
+        setTimeSteps(rhs._time_steps);
+        _is_prepared = false;
 
         // _output = rhs._output;
         // *_acados_ocp_capsule = *rhs._acados_ocp_capsule;
@@ -74,50 +184,187 @@ namespace MPCPlanner
         return *this;
     }
 
+    void Solver::copySolverMemory(const Solver &other)
+    {
+        // Primal iterate and multipliers (both capsules are the same generated solver, i.e., the dimensions match)
+        for (const char *field : ITERATE_FIELDS)
+        {
+            ocp_nlp_get_all(other._nlp_solver, other._nlp_in, other._nlp_out, field, _iterate_buffer.data());
+            ocp_nlp_set_all(_nlp_solver, _nlp_in, _nlp_out, field, _iterate_buffer.data());
+        }
+
+        // HPIPM warm starts from the last QP solution (of the partially condensed QP)
+        for (const char *field : {"qp_out", "qp_xcond_out"})
+        {
+            struct d_ocp_qp_sol *other_qp_out, *qp_out;
+            ocp_nlp_get(other._nlp_solver, field, &other_qp_out);
+            ocp_nlp_get(_nlp_solver, field, &qp_out);
+            d_ocp_qp_sol_copy_all(other_qp_out, qp_out);
+        }
+
+        _warm_start = WarmStartType::COPIED;
+        _is_prepared = false;
+    }
+
+    void Solver::resetSolverMemory()
+    {
+        ocp_nlp_solver_reset_qp_memory(_nlp_solver, _nlp_in, _nlp_out);
+        _warm_start = WarmStartType::COLD;
+        _is_prepared = false;
+    }
+
     void Solver::reset()
     {
         _params = AcadosParameters();
         _info = AcadosInfo();
         _output = AcadosOutput();
+        _is_prepared = false;
+        _warm_start = WarmStartType::COLD;
     }
 
     int Solver::solve()
     {
-        int status = 1;
+        PROFILE_SCOPE("Solver::solve");
 
-        auto timeout_start = std::chrono::steady_clock::now();
+        // The deadline is monotonic and fixed at the start of the solve
+        auto solve_start = std::chrono::steady_clock::now();
+        _deadline = solve_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                      std::chrono::duration<double>(_params.solver_timeout));
 
         // _params.printParameters(_parameter_map);
 
+        bool feedback_only = _is_prepared;
         initializeOneIteration();
-        double iteration_time_sum = 0.0;
 
-        for (int iteration = 0; iteration < _num_iterations; iteration++)
+        double max_iteration_time = 0.;
+        bool deadline_reached = false;
+
+        int num_iterations = _iteration_limit > 0 ? std::min(_iteration_limit, _num_iterations) : _num_iterations;
+        for (int iteration = 0; iteration < num_iterations; iteration++)
         {
+            // Keep the last completed iterate if the next iteration may not finish in time
+            double remaining_time = getRemainingTime();
+            if (iteration > 0 && remaining_time < max_iteration_time)
+            {
+                LOG_WARN_THROTTLE(15000., "Deadline reached. Stopping after " << iteration << " iterations because planning time is exceeded");
+                deadline_reached = true;
+                break;
+            }
+
+            if (!limitToDeadline(remaining_time))
+            {
+                if (iteration > 0)
+                {
+                    deadline_reached = true;
+                    break;
+                }
+
+                // Not even a single QP iteration fits: an iterate capped that far is not a solution
+                LOG_WARN_THROTTLE(15000., "Deadline reached. Skipped the solve because planning time is exceeded");
+                int exit_code = skipSolve();
+                recordStatistics(exit_code, std::chrono::duration<double>(std::chrono::steady_clock::now() - solve_start).count());
+                return exit_code;
+            }
+
             auto iter_start = std::chrono::steady_clock::now();
 
-            solveOneIteration();
+            int status = solveOneIteration();
 
-            if (status != ACADOS_SUCCESS && _info.qp_status != 0)
-                break;
+            if (feedback_only && iteration == 0 && num_iterations > 1)
+            {
+                // Further iterations linearize again, now with the parameters of this cycle
+                uploadParameters();
+                setRtiPhase(0);
+            }
 
-            auto iter_end = std::chrono::steady_clock::now();
-            double elapsed_this_iter = std::chrono::duration<double>(iter_end - iter_start).count();
+            double elapsed_this_iter = std::chrono::duration<double>(std::chrono::steady_clock::now() - iter_start).count();
+            max_iteration_time = std::max(max_iteration_time, elapsed_this_iter);
 
-            iteration_time_sum += elapsed_this_iter;
-            double avg_iteration_time = iteration_time_sum / static_cast<double>(iteration + 1);
+            // The QP iterations were capped to make the deadline: the iterate is consistent, but the QP did not converge
+            if (_info.qp_status == ACADOS_MAXITER && _qp_iter_limit < _qp_iter_max)
+                deadline_reached = true;
 
-            auto now = std::chrono::steady_clock::now();
-            double total_elapsed = std::chrono::duration<double>(now - timeout_start).count();
+            if (status == ACADOS_TIMEOUT) // The SQP solver stopped itself
+                deadline_reached = true;
 
-            // Stop iterating if we ran out of time
-            if (total_elapsed + avg_iteration_time >= _params.solver_timeout)
-            {
-                LOG_WARN_THROTTLE(15000., "Timeout is enabled. Stopping after " << iteration + 1 << " iterations because planning time is exceeded");
+            if (deadline_reached || (status != ACADOS_SUCCESS && _info.qp_status != 0))
                 break;
-            }
         }
-        return completeOneIteration();
+
+        int exit_code = completeOneIteration();
+        if (deadline_reached && exit_code == 1)
+            exit_code = ACADOS_TIMEOUT; // Distinct from success, but the solution can be used
+
+        recordStatistics(exit_code, std::chrono::duration<double>(std::chrono::steady_clock::now() - solve_start).count());
+        return exit_code;
+    }
+
+    void Solver::recordStatistics(int exit_code, double wall_time)
+    {
+        SolveRecord record;
+        record.cycle = _num_solves++;
+        record.solver_id = _solver_id;
+        record.wall_time = wall_time;
+        record.time_tot = _info.solvetime;
+        record.time_lin = _info.linearization_time;
+        record.time_qp = _info.qp_time;
+        record.sqp_iter = _info.sqp_iter;
+        record.qp_iter = _info.qp_iter;
+        record.exit_code = exit_code;
+        record.warm_start = (int)_info.warm_start;
+        _statistics.record(record);
+    }
+
+    double Solver::getRemainingTime() const
+    {
+        return std::chrono::duration<double>(_deadline - std::chrono::steady_clock::now()).count();
+    }
+
+    bool Solver::limitToDeadline(double remaining_time)
+    {
+        if (remaining_time <= 0.)
+            return false; // The deadline passed (also before the first iterations were timed)
+
+        // Cap the QP iterations to the number that fits in the remaining time (estimated from previous iterations)
+        int qp_iter_limit = _qp_iter_max;
+        if (_qp_iteration_time > 0.)
+        {
+            double qp_time = remaining_time - _linearization_time;
+            if (qp_time < _qp_iteration_time)
+                return false; // Not even one linearization and one QP iteration fit
+
+            qp_iter_limit = std::min(_qp_iter_max, (int)(qp_time / _qp_iteration_time));
+        }
+
+        if (qp_iter_limit != _qp_iter_limit)
+        {
+            ocp_nlp_solver_opts_set(_nlp_config, _nlp_opts, "qp_iter_max", &qp_iter_limit);
+            _qp_iter_limit = qp_iter_limit;
+        }
+
+        // The SQP solver checks the deadline before each of its iterations
+        if (!_is_rti)
+        {
+            double timeout_max_time = std::max(remaining_time, 1e-6);
+            ocp_nlp_solver_opts_set(_nlp_config, _nlp_opts, "timeout_max_time", &timeout_max_time);
+        }
+
+        return true;
+    }
+
+    int Solver::skipSolve()
+    {
+        // The output becomes the loaded initial guess (e.g., the shifted previous solution). DEADLINE_SKIPPED is not a
+        // usable solution (hasUsableSolution()), so the planner reports a failure and initializes the next cycle with
+        // braking. The multipliers are kept for the next warm start
+        for (int k = 0; k <= _nlp_dims->N; k++)
+            ocp_nlp_out_get(_nlp_config, _nlp_dims, _nlp_out, k, "x", &_output.xtraj[k * nx]);
+        for (int k = 0; k < _nlp_dims->N; k++)
+            ocp_nlp_out_get(_nlp_config, _nlp_dims, _nlp_out, k, "u", &_output.utraj[k * nu]);
+
+        _is_prepared = false;
+        _exit_code_one_iter = DEADLINE_SKIPPED;
+        return DEADLINE_SKIPPED;
     }
 
     void Solver::initializeOneIteration()
@@ -126,22 +373,94 @@ namespace MPCPlanner
         ocp_nlp_constraints_model_set(_nlp_config, _nlp_dims, _nlp_in, 0, "lbx", _params.xinit);
         ocp_nlp_constraints_model_set(_nlp_config, _nlp_dims, _nlp_in, 0, "ubx", _params.xinit);
 
-        // Set parameters
-        for (int k = 0; k <= N; k++)
+        if (_is_prepared)
         {
-            if (k == N)
-                Solver_acados_update_params(_acados_ocp_capsule, k, &_params.all_parameters[(N - 1) * SOLVER_NP], SOLVER_NP); // Insert the second to last set of parameters
-            else
-                Solver_acados_update_params(_acados_ocp_capsule, k, &_params.all_parameters[k * SOLVER_NP], SOLVER_NP);
+            /** @note The QP was built in prepare(). Parameters set since then are used from the next linearization onwards */
+            AcadosInfo prepared_info = _info;
+            _info = AcadosInfo();
+            _info.preparation_time = prepared_info.preparation_time;
+            _info.uploaded_stages = prepared_info.uploaded_stages;
+            _info.uploaded_bytes = prepared_info.uploaded_bytes;
+            _info.warm_start = _warm_start;
+
+            setRtiPhase(2); // Feedback only
+            _is_prepared = false;
+            return;
         }
 
         _info = AcadosInfo();
+        _info.warm_start = _warm_start;
 
-        // solve ocp in loop
-        int rti_phase = 0; // 1 = prep, 2 = feedback, 0 = both
+        uploadParameters();
+
+        setRtiPhase(0); // 1 = prep, 2 = feedback, 0 = both
+
+        // The solver is precomputed on creation, only redo this when the time grid changes
+        if (_precompute_needed)
+        {
+            ocp_nlp_precompute(_nlp_solver, _nlp_in, _nlp_out);
+            _precompute_needed = false;
+        }
+    }
+
+    void Solver::prepare()
+    {
+        if (!_rti_split)
+            return;
+
+        _info.uploaded_stages = 0;
+        _info.uploaded_bytes = 0;
+        uploadParameters();
+
+        if (_precompute_needed)
+        {
+            ocp_nlp_precompute(_nlp_solver, _nlp_in, _nlp_out);
+            _precompute_needed = false;
+        }
+
+        setRtiPhase(1);
+        Solver_acados_solve(_acados_ocp_capsule); // The preparation phase does not report a status
+
+        _info.preparation_time = 0.;
+        ocp_nlp_get(_nlp_solver, "time_preparation", &_info.preparation_time);
+
+        _is_prepared = true;
+    }
+
+    void Solver::setRtiPhase(int rti_phase)
+    {
+        if (rti_phase == _rti_phase)
+            return;
 
         ocp_nlp_solver_opts_set(_nlp_config, _nlp_opts, "rti_phase", &rti_phase);
-        ocp_nlp_precompute(_nlp_solver, _nlp_in, _nlp_out);
+        _rti_phase = rti_phase;
+    }
+
+    void Solver::uploadParameters()
+    {
+        // Only send the stages (and the range within each stage) that changed since the last upload
+        for (int k = 0; k < N; k++)
+        {
+            if (!_params.isDirty(k))
+                continue;
+
+            int begin = _params.dirty_begin[k];
+            int count = _params.dirty_end[k] - begin;
+            double *values = &_params.all_parameters[k * SOLVER_NP];
+
+            int num_stages = (k == N - 1) ? 2 : 1; // Insert the second to last set of parameters also at stage N
+            for (int stage = k; stage < k + num_stages; stage++)
+            {
+                if (count == SOLVER_NP)
+                    Solver_acados_update_params(_acados_ocp_capsule, stage, values, SOLVER_NP);
+                else
+                    Solver_acados_update_params_sparse(_acados_ocp_capsule, stage, &_parameter_indices[begin], &values[begin], count);
+            }
+
+            _info.uploaded_stages += num_stages;
+            _info.uploaded_bytes += num_stages * count * sizeof(double);
+            _params.markClean(k);
+        }
     }
 
     int Solver::solveOneIteration()
@@ -154,8 +473,34 @@ namespace MPCPlanner
         _info.solvetime += _info.elapsed_time;
         _info.min_time = MIN(_info.elapsed_time, _info.min_time);
 
+        double phase_time = 0.;
+        if (_rti_phase != 2)
+        {
+            ocp_nlp_get(_nlp_solver, "time_preparation", &phase_time);
+            _info.preparation_time += phase_time;
+        }
+        ocp_nlp_get(_nlp_solver, "time_feedback", &phase_time);
+        _info.feedback_time += phase_time;
+
         ocp_nlp_get(_nlp_solver, "qp_status", &_info.qp_status);
 
+        int qp_iter = 0;
+        ocp_nlp_get(_nlp_solver, "qp_iter", &qp_iter);
+        _info.qp_iter += qp_iter;
+
+        // Conservative (slowly decaying maximum) estimates of the time per QP iteration and for everything else
+        double time_qp = 0.;
+        ocp_nlp_get(_nlp_solver, "time_qp", &time_qp);
+        _info.qp_time += time_qp;
+
+        double time_lin = 0.;
+        ocp_nlp_get(_nlp_solver, "time_lin", &time_lin);
+        _info.linearization_time += time_lin;
+
+        if (qp_iter > 0)
+            _qp_iteration_time = std::max(time_qp / (double)qp_iter, 0.9 * _qp_iteration_time);
+        _linearization_time = std::max(_info.elapsed_time - time_qp, 0.9 * _linearization_time);
+
         _exit_code_one_iter = status;
 
         return status;
@@ -177,19 +522,25 @@ namespace MPCPlanner
 
         double res_stat, res_eq, res_ineq, res_comp;
         ocp_nlp_get(_nlp_solver, "res_eq", &res_eq);
-        if (res_eq > 1e-2 && _exit_code_one_iter == ACADOS_SUCCESS)
+        if (res_eq > 1e-2 && (_exit_code_one_iter == ACADOS_SUCCESS || _exit_code_one_iter == ACADOS_TIMEOUT))
         {
             _exit_code_one_iter = ACADOS_QP_FAILURE;
         }
 
-        if (_exit_code_one_iter == ACADOS_SUCCESS)
+        if (_exit_code_one_iter == ACADOS_TIMEOUT) // Interrupted by the deadline at a consistent iterate
+        {
+            LOG_MARK("Solver_acados_solve(): TIMEOUT");
+            _warm_start = WarmStartType::PREVIOUS;
+        }
+        else if (_exit_code_one_iter == ACADOS_SUCCESS)
         {
             LOG_MARK("Solver_acados_solve(): SUCCESS!");
+            _warm_start = WarmStartType::PREVIOUS;
         }
         else
         {
             Solver_acados_reset(_acados_ocp_capsule, 1);
-            ocp_nlp_solver_reset_qp_memory(_nlp_solver, _nlp_in, _nlp_out);
+            resetSolverMemory();
         }
 
         // Get INFO
@@ -208,69 +559,58 @@ namespace MPCPlanner
     // PARAMETERS //
     bool Solver::hasParameter(std::string &&parameter)
     {
-        return _parameter_map[parameter].IsDefined();
+        return Layout::paramIndex(parameter) != -1;
     }
 
     void Solver::setParameter(int k, std::string &&parameter, double value)
     {
-        _params.all_parameters[k * npar + _parameter_map[parameter].as<int>()] = value;
+        setParameter(k, checkedParamIndex(parameter), value);
     }
 
     void Solver::setParameter(int k, std::string &parameter, double value)
     {
-        _params.all_parameters[k * npar + _parameter_map[parameter].as<int>()] = value;
+        setParameter(k, checkedParamIndex(parameter), value);
     }
 
     double Solver::getParameter(int k, std::string &&parameter)
     {
-        return _params.all_parameters[k * npar + _parameter_map[parameter].as<int>()];
+        return getParameter(k, checkedParamIndex(parameter));
     }
 
     // XINIT //
 
     void Solver::setXinit(std::string &&state_name, double value)
     {
-        _params.xinit[_model_map[state_name][1].as<int>() - nu] = value;
+        setXinit(checkedVarIndex(state_name), value);
     }
 
     void Solver::setXinit(const State &state)
     {
-        for (YAML::const_iterator it = _model_map.begin(); it != _model_map.end(); ++it)
-        {
-            if (it->second[0].as<std::string>() == "x")
-            {
-                // it->first.as<std::string>() is the variable name
-                setXinit(
-                    it->first.as<std::string>(),
-                    state.get(it->first.as<std::string>()));
-            }
-        }
+        for (int i = Layout::NUM_INPUTS; i < Layout::NUM_VARIABLES; i++)
+            setXinit(i, state.get(i));
     }
 
     // WARMSTART //
 
     void Solver::setEgoPrediction(unsigned int k, std::string &&var_name, double value)
     {
-        int index = _model_map[var_name][1].as<int>();
-        _params.x0[k * nvar + index] = value;
+        setEgoPrediction(k, checkedVarIndex(var_name), value);
     }
 
     double Solver::getEgoPrediction(unsigned int k, std::string &&var_name)
     {
-
-        int index = _model_map[var_name][1].as<int>();
-        return _params.x0[k * nvar + index];
+        return getEgoPrediction(k, checkedVarIndex(var_name));
     }
 
     void Solver::setEgoPredictionPosition(unsigned int k, const Eigen::Vector2d &value)
     {
-        setEgoPrediction(k, "x", value(0));
-        setEgoPrediction(k, "y", value(1));
+        setEgoPrediction(k, Layout::Var::X, value(0));
+        setEgoPrediction(k, Layout::Var::Y, value(1));
     }
 
     Eigen::Vector2d Solver::getEgoPredictionPosition(unsigned int k)
     {
-        return Eigen::Vector2d(getEgoPrediction(k, "x"), getEgoPrediction(k, "y"));
+        return Eigen::Vector2d(getEgoPrediction(k, Layout::Var::X), getEgoPrediction(k, Layout::Var::Y));
     }
 
     void Solver::loadWarmstart()
@@ -287,18 +627,12 @@ namespace MPCPlanner
 
     void Solver::initializeWithState(const State &initial_state)
     {
-        for (int k = 0; k <= N; k++) // For all timesteps
+        // Inputs zero, states at the initial state for all stages
+        for (int k = 0; k <= N; k++)
         {
-            // LOG_HEADER(k);
-            for (YAML::const_iterator it = _model_map.begin(); it != _model_map.end(); ++it) // For all inputs and states
-            {
-                if (_model_map[it->first.as<std::string>()][0].as<std::string>() == "x") // Set states to initial state
-                    setEgoPrediction(k, it->first.as<std::string>(), initial_state.get(it->first.as<std::string>()));
-                else
-                    setEgoPrediction(k, it->first.as<std::string>(), 0.);
-
-                // LOG_VALUE(it->first.as<std::string>(), getEgoPrediction(k, it->first.as<std::string>()));
-            }
+            double *stage = &_params.x0[k * Layout::NUM_VARIABLES];
+            std::fill_n(stage, Layout::NUM_INPUTS, 0.);
+            std::copy_n(initial_state.data(), Layout::NUM_STATES, stage + Layout::NUM_INPUTS);
         }
     }
 
@@ -307,40 +641,56 @@ namespace MPCPlanner
         LOG_MARK("Initialize Plan with a Braking Plan");
         initializeWithState(initial_state); // Initialize all variables
 
-        double x, y, psi, v, a, spline;
-        double deceleration = std::abs(CONFIG["deceleration_at_infeasible"].as<double>());
-
-        x = initial_state.get("x");
-        y = initial_state.get("y");
-        psi = initial_state.get("psi");
-        v = initial_state.get("v");
-        spline = initial_state.get("spline");
-        a = -deceleration;
-
-        setEgoPrediction(0, "x", x);
-        setEgoPrediction(0, "y", y);
-        setEgoPrediction(0, "psi", psi);
-        setEgoPrediction(0, "v", v);
-        setEgoPrediction(0, "spline", spline);
-        setEgoPrediction(0, "a", a);
-        setEgoPrediction(0, "w", 0);
-
-        for (int k = 1; k <= N; k++) // For all timesteps
-        {
-            x += v * dt * std::cos(psi);
-            y += v * dt * std::sin(psi);
-            spline += v * dt;
-            v += a * dt;
-            v = std::max(v, 0.);
-
-            setEgoPrediction(k, "x", x);
-            setEgoPrediction(k, "y", y);
-            setEgoPrediction(k, "psi", psi);
-            setEgoPrediction(k, "v", v);
-            setEgoPrediction(k, "spline", spline);
-            setEgoPrediction(k, "a", a);
-            setEgoPrediction(k, "w", 0);
-        }
+        double deceleration = std::abs(CONFIG_SNAPSHOT.deceleration_at_infeasible);
+        double psi = initial_state.get(Layout::Var::PSI);
+        double v0 = initial_state.get(Layout::Var::V);
+
+        // Stages are the columns of the warmstart
+        Eigen::Map<Eigen::Matrix<double, Layout::NUM_VARIABLES, Eigen::Dynamic>> warmstart(_params.x0, Layout::NUM_VARIABLES, N + 1);
+
+        // Constant deceleration until standstill: v_k = max(v_0 - a t_k, 0) (v_0 itself at k = 0)
+        Eigen::Map<const Eigen::ArrayXd> stage_times(_stage_times, N + 1);
+        Eigen::Map<const Eigen::ArrayXd> time_steps(_time_steps, N);
+        Eigen::ArrayXd v = (v0 - deceleration * stage_times).max(0.);
+        v(0) = v0;
+
+        // Distance travelled up to each stage
+        Eigen::ArrayXd distance(N + 1);
+        distance(0) = 0.;
+        Eigen::ArrayXd step_distance = v.head(N) * time_steps;
+        std::partial_sum(step_distance.data(), step_distance.data() + N, distance.data() + 1);
+
+        warmstart.row(Layout::Var::X).array() = initial_state.get(Layout::Var::X) + std::cos(psi) * distance.transpose();
+        warmstart.row(Layout::Var::Y).array() = initial_state.get(Layout::Var::Y) + std::sin(psi) * distance.transpose();
+        warmstart.row(Layout::Var::SPLINE).array() = initial_state.get(Layout::Var::SPLINE) + distance.transpose();
+        warmstart.row(Layout::Var::V) = v.matrix().transpose();
+        warmstart.row(Layout::Var::A).setConstant(-deceleration);
+        warmstart.row(Layout::Var::W).setZero();
+    }
+
+    void Solver::copyOutputToWarmstart(int k_output, int k)
+    {
+        double *stage = &_params.x0[k * Layout::NUM_VARIABLES];
+        std::copy_n(&_output.utraj[std::min(k_output, N - 1) * Layout::NUM_INPUTS], Layout::NUM_INPUTS, stage); // No inputs at N
+        std::copy_n(&_output.xtraj[k_output * Layout::NUM_STATES], Layout::NUM_STATES, stage + Layout::NUM_INPUTS);
+    }
+
+    void Solver::extrapolateTerminalStage()
+    {
+        std::copy_n(&_params.x0[(N - 1) * Layout::NUM_VARIABLES], Layout::NUM_VARIABLES, &_params.x0[N * Layout::NUM_VARIABLES]);
+        if (_terminal_extrapolation == TerminalExtrapolation::HOLD)
+            return;
+
+        // One step of the unicycle model with the final inputs
+        double step = getTimeStep(N - 1);
+        double psi = getEgoPrediction(N - 1, Layout::Var::PSI);
+        double v = getEgoPrediction(N - 1, Layout::Var::V);
+
+        setEgoPrediction(N, Layout::Var::X, getEgoPrediction(N - 1, Layout::Var::X) + v * step * std::cos(psi));
+        setEgoPrediction(N, Layout::Var::Y, getEgoPrediction(N - 1, Layout::Var::Y) + v * step * std::sin(psi));
+        setEgoPrediction(N, Layout::Var::PSI, psi + getEgoPrediction(N - 1, Layout::Var::W) * step);
+        setEgoPrediction(N, Layout::Var::V, v + getEgoPrediction(N - 1, Layout::Var::A) * step);
+        setEgoPrediction(N, Layout::Var::SPLINE, getEgoPrediction(N - 1, Layout::Var::SPLINE) + v * step);
     }
 
     void Solver::initializeWarmstart(const State &initial_state, bool shift_previous_solution_forward)
@@ -348,46 +698,26 @@ namespace MPCPlanner
         if (shift_previous_solution_forward)
         {
             /** @note warmstart shifting the previous output by one time step */
-            // [initial_state, x_2, x_3, ..., x_N-1, x_N-1]
-            for (int k = 0; k <= N; k++) // For all timesteps
-            {
-                for (YAML::const_iterator it = _model_map.begin(); it != _model_map.end(); ++it) // For all inputs and states
-                {
-                    if (k == 0) // Load the current state at k = 0
-                        setEgoPrediction(0, it->first.as<std::string>(), initial_state.get(it->first.as<std::string>()));
-                    else if (k == N - 1) // extrapolate with the terminal state at k = N-1
-                        setEgoPrediction(N - 1, it->first.as<std::string>(), getOutput(N - 1, it->first.as<std::string>()));
-                    else if (k == N)
-                        setEgoPrediction(N, it->first.as<std::string>(), getOutput(N - 1, it->first.as<std::string>()));
-                    else // use x_{k+1} to initialize x_{k} (note that both have the initial state)
-                        setEgoPrediction(k, it->first.as<std::string>(), getOutput(k + 1, it->first.as<std::string>()));
-                }
-            }
+            // [initial_state, x_2, x_3, ..., x_N, extrapolated]
+            for (int k = 0; k < N; k++)
+                copyOutputToWarmstart(k + 1, k); // x_{k+1} initializes x_k (both have the initial state)
+
+            std::copy_n(initial_state.data(), Layout::NUM_STATES, &_params.x0[Layout::NUM_INPUTS]);
+            extrapolateTerminalStage();
         }
         else
         {
-
             /** @note warmstart maintaining the previous output */
-            // [initial_state, x_1, x_2, ..., x_N-1, x_N]
-            for (int k = 0; k < N; k++) // For all timesteps
-            {
-                for (YAML::const_iterator it = _model_map.begin(); it != _model_map.end(); ++it)                 // For all inputs and states
-                    setEgoPrediction(k, it->first.as<std::string>(), getOutput(k, it->first.as<std::string>())); // Initialize with the previous output
-            }
+            // [x_0, x_1, x_2, ..., x_N-1, x_N]
+            for (int k = 0; k <= N; k++)
+                copyOutputToWarmstart(k, k);
         }
     }
 
     // OUTPUT //
     double Solver::getOutput(int k, std::string &&state_name) const
     {
-        if (_model_map[state_name][0].as<std::string>() == "x")
-        {
-            return _output.xtraj[k * nx + _model_map[state_name][1].as<int>() - nu];
-        }
-        else
-        {
-            return _output.utraj[k * nu + _model_map[state_name][1].as<int>()];
-        }
+        return getOutput(k, checkedVarIndex(state_name));
     }
 
     std::string Solver::explainExitFlag(int exitflag) const
@@ -404,6 +734,10 @@ namespace MPCPlanner
             return "Failure (minimum step size reached)";
         case 4:
             break;
+        case ACADOS_TIMEOUT:
+            return "Deadline reached (returned the last completed iterate)";
+        case DEADLINE_SKIPPED:
+            return "Deadline reached before a single iteration fit (returned the initial guess, not a solution)";
         default:
             return "Unknown exit code";
         }
@@ -430,18 +764,18 @@ namespace MPCPlanner
         // For all outputs, check whether they are close (within 1e-2) to their bounds on either side
         for (int k = 0; k < N; k++)
         {
-            for (YAML::const_iterator it = _model_map.begin(); it != _model_map.end(); ++it)
+            for (int i = 0; i < Layout::NUM_VARIABLES; i++)
             {
-                if (k == 0 && it->second[0].as<std::string>() == "x")
+                if (k == 0 && Layout::isState(i))
                     continue;
 
-                if (std::abs(getOutput(k, it->first.as<std::string>()) - it->second[2].as<double>()) < 1e-2)
+                if (std::abs(getOutput(k, i) - Layout::LOWER_BOUND[i]) < 1e-2)
                 {
-                    LOG_WARN_THROTTLE(500, it->first.as<std::string>() + " limited by lower bound");
+                    LOG_WARN_THROTTLE(500, std::string(Layout::VAR_NAMES[i]) + " limited by lower bound");
                 }
-                if (std::abs(getOutput(k, it->first.as<std::string>()) - it->second[3].as<double>()) < 1e-2)
+                if (std::abs(getOutput(k, i) - Layout::UPPER_BOUND[i]) < 1e-2)
                 {
-                    LOG_WARN_THROTTLE(500, it->first.as<std::string>() + " limited by upper bound");
+                    LOG_WARN_THROTTLE(500, std::string(Layout::VAR_NAMES[i]) + " limited by upper bound");
                 }
             }
         }
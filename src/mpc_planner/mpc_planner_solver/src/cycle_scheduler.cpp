@@ -0,0 +1,134 @@
+#include <mpc_planner_solver/cycle_scheduler.h>
+
+#include <ros_tools/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace MPCPlanner
+{
+    namespace
+    {
+        const char *PHASE_NAMES[CycleScheduler::NUM_PHASES] = {"data preparation", "module update", "parameters", "solve",
+                                                               "post-processing"};
+
+        std::chrono::steady_clock::duration toDuration(double seconds)
+        {
+            return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+        }
+    }
+
+    CycleScheduler::CycleScheduler(const Settings &settings, int max_iterations)
+        : _settings(settings), _max_iterations(std::max(max_iterations, 1)), _iteration_cap(_max_iterations)
+    {
+    }
+
+    void CycleScheduler::startCycle(std::chrono::system_clock::time_point planning_start_time)
+    {
+        // The planning start time is set by the caller (system clock), the deadline is kept on the monotonic clock
+        std::chrono::duration<double> used_time = std::chrono::system_clock::now() - planning_start_time;
+
+        _phase_start = std::chrono::steady_clock::now();
+        _deadline = _phase_start + toDuration(_settings.control_period - used_time.count());
+        _phase = Phase::DATA_PREPARATION;
+        _last.fill(0.);
+        _running = true;
+    }
+
+    void CycleScheduler::startPhase(Phase phase)
+    {
+        endPhase();
+        _phase = phase;
+
+        if (phase == Phase::SOLVE)
+            _solve_budget = getSolverBudget();
+    }
+
+    void CycleScheduler::endPhase()
+    {
+        auto now = std::chrono::steady_clock::now();
+        _last[(int)_phase] += std::chrono::duration<double>(now - _phase_start).count();
+        _phase_start = now;
+    }
+
+    void CycleScheduler::endCycle()
+    {
+        if (!_running)
+            return;
+
+        endPhase();
+        _running = false;
+
+        // Expect the slowest recent post-processing (decays slowly)
+        _post_processing_time = std::max(_last[(int)Phase::POST_PROCESSING], 0.9 * _post_processing_time);
+
+        for (int i = 0; i < NUM_PHASES; i++)
+        {
+            _total[i] += _last[i];
+            _max[i] = std::max(_max[i], _last[i]);
+        }
+        _num_cycles++;
+
+        double overrun = std::chrono::duration<double>(_phase_start - _deadline).count();
+        if (overrun > 0.)
+        {
+            _num_misses++;
+            _max_overrun = std::max(_max_overrun, overrun);
+            LOG_WARN_THROTTLE(5000, "Planning cycle missed its deadline by " << overrun * 1000. << " ms ("
+                                                                             << _num_misses << " misses in " << _num_cycles << " cycles)");
+        }
+    }
+
+    CycleScheduler::Deadline CycleScheduler::getSolverDeadline() const
+    {
+        return _deadline - toDuration(_post_processing_time + _settings.margin);
+    }
+
+    double CycleScheduler::getSolverBudget() const
+    {
+        return std::chrono::duration<double>(getSolverDeadline() - std::chrono::steady_clock::now()).count();
+    }
+
+    int CycleScheduler::getIterationLimit() const
+    {
+        if (!_settings.adapt_iterations)
+            return _max_iterations;
+
+        return std::max(1, std::min(_max_iterations, (int)std::lround(_iteration_cap)));
+    }
+
+    void CycleScheduler::onSolved()
+    {
+        if (!_settings.adapt_iterations || _solve_budget <= 0.)
+            return;
+
+        // Integral control of the solver utilization: fewer iterations when the solves get close to the budget, more
+        // when there is time left
+        double solve_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - _phase_start).count() +
+                            _last[(int)Phase::SOLVE];
+        double utilization = solve_time / _solve_budget;
+
+        _iteration_cap += _settings.gain * (_settings.target_utilization - utilization) * (double)_max_iterations;
+        _iteration_cap = std::max(1., std::min((double)_max_iterations, _iteration_cap));
+    }
+
+    void CycleScheduler::print() const
+    {
+        if (_num_cycles == 0)
+            return;
+
+        LOG_DIVIDER();
+        LOG_VALUE("Planning cycles", _num_cycles);
+        for (int i = 0; i < NUM_PHASES; i++)
+        {
+            LOG_VALUE(std::string("Average ") + PHASE_NAMES[i] + " (ms)", _total[i] / (double)_num_cycles * 1000.);
+            LOG_VALUE(std::string("Max ") + PHASE_NAMES[i] + " (ms)", _max[i] * 1000.);
+        }
+        LOG_VALUE("Deadline misses", _num_misses);
+        if (_num_misses > 0)
+            LOG_VALUE("Max overrun (ms)", _max_overrun * 1000.);
+        if (_settings.adapt_iterations)
+            LOG_VALUE("SQP iteration cap", getIterationLimit() << " / " << _max_iterations);
+    }
+}
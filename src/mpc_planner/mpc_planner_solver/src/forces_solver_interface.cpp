@@ -6,6 +6,8 @@
 
 #include "mpc_planner_generated.h"
 
+#include <chrono>
+
 extern "C"
 {
 	Solver_extfunc extfunc_eval_ = &Solver_adtool2forces;
@@ -15,19 +17,25 @@ namespace MPCPlanner
 {
 	Solver::Solver(int solver_id)
 	{
+		auto creation_start = std::chrono::steady_clock::now();
 		_solver_id = solver_id;
 		_solver_memory = (char *)malloc(Solver_get_mem_size());
 		_solver_memory_handle = Solver_external_mem(_solver_memory, _solver_id, Solver_get_mem_size());
-		loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "solver_settings"), _config);
-		loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "parameter_map"), _parameter_map);
-		loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "model_map"), _model_map);
+
+		// Parsed once for all solvers. The maps are cloned, YAML nodes are not safe to share between threads
+		auto definition = SolverDefinition::get();
+		_config = YAML::Clone(definition->solver_settings);
+		_parameter_map = YAML::Clone(definition->parameter_map);
+		_model_map = YAML::Clone(definition->model_map);
 		N = _config["N"].as<unsigned int>();
 		nu = _config["nu"].as<unsigned int>();
 		nx = _config["nx"].as<unsigned int>();
 		nvar = _config["nvar"].as<unsigned int>();
 		npar = _config["npar"].as<unsigned int>();
-		dt = CONFIG["integrator_step"].as<double>();
+		dt = definition->dt;
 		reset();
+
+		_creation_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - creation_start).count();
 	}
 
 	void Solver::reset()
@@ -118,7 +126,7 @@ namespace MPCPlanner
 		initializeWithState(initial_state); // Initialize all variables
 
 		double x, y, psi, v, a;
-		double deceleration = CONFIG["deceleration_at_infeasible"].as<double>();
+		double deceleration = CONFIG_SNAPSHOT.deceleration_at_infeasible;
 
 		x = initial_state.get("x");
 		y = initial_state.get("y");
@@ -146,37 +154,17 @@ namespace MPCPlanner
 
 	void Solver::initializeWarmstart(const State &initial_state, bool shift_previous_solution_forward)
 	{
-		if (shift_previous_solution_forward)
-		{
-			/** @note warmstart shifting the previous output by one time step */
-			// [initial_state, x_2, x_3, ..., x_N-1, x_N-1]
-			for (int k = 0; k < N; k++) // For all timesteps
-			{
-				for (YAML::const_iterator it = _model_map.begin(); it != _model_map.end(); ++it) // For all inputs and states
-				{
-					if (k == 0) // Load the current state at k = 0
-						setEgoPrediction(0, it->first.as<std::string>(), initial_state.get(it->first.as<std::string>()));
-					else if (k == N - 1) // extrapolate with the terminal state at k = N-1
-						setEgoPrediction(k, it->first.as<std::string>(), getOutput(k, it->first.as<std::string>()));
-					else // use x_{k+1} to initialize x_{k} (note that both have the initial state)
-						setEgoPrediction(k, it->first.as<std::string>(), getOutput(k + 1, it->first.as<std::string>()));
-				}
-			}
-		}
-		else
+		/** @note The FORCES output is one struct member per stage, so this copies by variable index instead of by stage */
+		for (int k = 0; k < N; k++) // For all timesteps
 		{
-
-			/** @note warmstart maintaining the previous output */
-			// [initial_state, x_1, x_2, ..., x_N-1, x_N]
-			for (int k = 0; k < N; k++) // For all timesteps
+			for (int i = 0; i < Layout::NUM_VARIABLES; i++) // For all inputs and states
 			{
-				for (YAML::const_iterator it = _model_map.begin(); it != _model_map.end(); ++it) // For all inputs and states
-				{
-					if (k == 0) // Load the current state at k = 0
-						setEgoPrediction(0, it->first.as<std::string>(), initial_state.get(it->first.as<std::string>()));
-					else // use x_{k+1} to initialize x_{k} (note that both have the initial state)
-						setEgoPrediction(k, it->first.as<std::string>(), getOutput(k, it->first.as<std::string>()));
-				}
+				if (k == 0) // Load the current state at k = 0
+					setEgoPrediction(0, i, Layout::isState(i) ? initial_state.get(i) : getOutput(shift_previous_solution_forward ? 1 : 0, i));
+				else if (shift_previous_solution_forward && k < N - 1) // use x_{k+1} to initialize x_{k} (note that both have the initial state)
+					setEgoPrediction(k, i, getOutput(k + 1, i));
+				else // maintain the previous output (and extrapolate with the terminal state at k = N-1)
+					setEgoPrediction(k, i, getOutput(k, i));
 			}
 		}
 	}
@@ -217,7 +205,18 @@ namespace MPCPlanner
 
 	int Solver::solve()
 	{
+		auto solve_start = std::chrono::steady_clock::now();
 		int exit_code = Solver_solve(&_params, &_output, &_info, _solver_memory_handle, stdout, extfunc_eval_);
+
+		SolveRecord record;
+		record.cycle = _num_solves++;
+		record.solver_id = _solver_id;
+		record.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - solve_start).count();
+		record.time_tot = _info.solvetime;
+		record.sqp_iter = _info.it;
+		record.exit_code = exit_code;
+		_statistics.record(record);
+
 		return exit_code;
 	}
 
@@ -243,6 +242,11 @@ namespace MPCPlanner
 		return getForcesOutput(_output, k, _model_map[state_name][1].as<int>());
 	}
 
+	double Solver::getOutput(int k, int var_index) const
+	{
+		return getForcesOutput(_output, k, var_index);
+	}
+
 	std::string Solver::explainExitFlag(int exitflag)
 	{
 		switch (exitflag)
@@ -0,0 +1,85 @@
+#include <mpc_planner_solver/solver_batch.h>
+
+#include <ros_tools/logging.h>
+
+#include <string>
+#include <thread>
+
+namespace MPCPlanner
+{
+    SolverBatch::SolverBatch(int num_workers) : _workers(num_workers)
+    {
+    }
+
+    int SolverBatch::solve(std::vector<std::shared_ptr<Solver>> &solvers, const SetupFunction &setup, Deadline deadline,
+                           Policy policy, const SolveFunction &solve_function)
+    {
+        _results.assign(solvers.size(), Result());
+        _first_feasible = -1;
+
+        _workers.run(solvers.size(), [&](int problem)
+            {
+                Result &result = _results[problem];
+
+                if (std::chrono::steady_clock::now() >= deadline) // Out of time
+                    return;
+
+                if (policy == Policy::FIRST_FEASIBLE && _first_feasible != -1) // Another problem already won
+                    return;
+
+                Solver &solver = *solvers[problem];
+                if (!setup(problem, solver))
+                    return;
+
+                auto solve_start = std::chrono::steady_clock::now();
+                solver._params.solver_timeout = std::chrono::duration<double>(deadline - solve_start).count();
+
+                result.exit_code = solve_function ? solve_function(problem, solver) : solver.solve();
+                result.solve_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - solve_start).count();
+                result.solved = true;
+                result.success = solver.hasUsableSolution(result.exit_code);
+                result.objective = solver._info.pobj;
+
+                if (result.success)
+                {
+                    int no_winner = -1;
+                    _first_feasible.compare_exchange_strong(no_winner, problem);
+                } });
+
+        if (policy == Policy::FIRST_FEASIBLE)
+            return _first_feasible;
+
+        int best = -1;
+        for (size_t i = 0; i < _results.size(); i++)
+        {
+            if (_results[i].success && (best == -1 || _results[i].objective < _results[best].objective))
+                best = i;
+        }
+        return best;
+    }
+
+    std::vector<std::shared_ptr<Solver>> SolverBatch::createSolvers(const std::vector<int> &solver_ids)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        // Load the shared definition before the threads start, the solvers only read it
+        auto definition = SolverDefinition::get();
+
+        std::vector<std::shared_ptr<Solver>> solvers(solver_ids.size());
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < solver_ids.size(); i++)
+            threads.emplace_back([&, i]()
+                                 { solvers[i] = std::make_shared<Solver>(solver_ids[i]); });
+
+        for (auto &thread : threads)
+            thread.join();
+
+        LOG_VALUE("Solver definition loaded in [ms]", definition->load_time * 1000.);
+        for (auto &solver : solvers)
+            LOG_VALUE("Solver " + std::to_string(solver->_solver_id) + " created in [ms]", solver->getCreationTime() * 1000.);
+        LOG_VALUE("Created " + std::to_string(solvers.size()) + " solvers in [ms]",
+                  std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1000.);
+
+        return solvers;
+    }
+}
@@ -0,0 +1,74 @@
+#include <mpc_planner_solver/solver_definition.h>
+
+#include <mpc_planner_util/parameters.h>
+
+#include <chrono>
+#include <mutex>
+
+namespace MPCPlanner
+{
+    std::shared_ptr<const SolverDefinition> SolverDefinition::get()
+    {
+        static std::once_flag loaded;
+        static std::shared_ptr<SolverDefinition> definition;
+
+        std::call_once(loaded, []()
+                       {
+                           definition = std::make_shared<SolverDefinition>();
+                           definition->load(); });
+        return definition;
+    }
+
+    void SolverDefinition::load()
+    {
+        auto load_start = std::chrono::steady_clock::now();
+
+        loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "solver_settings"), solver_settings);
+        loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "parameter_map"), parameter_map);
+        loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "model_map"), model_map);
+
+        dt = CONFIG["integrator_step"].as<double>();
+
+        time_steps.fill(dt);
+        uniform_time_grid = true;
+
+        const YAML::Node &acados = CONFIG["solver_settings"]["acados"];
+        if (acados.IsDefined())
+        {
+            num_iterations = acados["iterations"].as<int>();
+            is_rti = acados["solver_type"].as<std::string>() == "SQP_RTI";
+
+            if (acados["qp_iter_max"].IsDefined())
+                qp_iter_max = acados["qp_iter_max"].as<int>();
+
+            // The preparation / feedback split is only available for the SQP_RTI solver
+            if (acados["rti_split"].IsDefined())
+                rti_split = acados["rti_split"].as<bool>() && is_rti;
+
+            if (acados["warm_start_first_qp"].IsDefined())
+            {
+                set_warm_start_first_qp = true;
+                warm_start_first_qp = acados["warm_start_first_qp"].as<bool>();
+            }
+
+            if (acados["time_grid"].IsDefined() && acados["time_grid"]["enable"].as<bool>())
+            {
+                // Fine steps where the prediction matters most, coarse steps to look further ahead with the same N
+                const YAML::Node &grid = acados["time_grid"];
+                int fine_stages = grid["fine_stages"].as<int>();
+                double fine_step = grid["fine_step"].as<double>();
+                double coarse_step = grid["coarse_step"].as<double>();
+
+                for (int k = 0; k < Layout::N; k++)
+                    time_steps[k] = k < fine_stages ? fine_step : coarse_step;
+
+                uniform_time_grid = false;
+            }
+        }
+
+        shift_terminal_rollout = CONFIG["shift_terminal_extrapolation"].IsDefined() &&
+                                 CONFIG["shift_terminal_extrapolation"].as<std::string>() == "rollout";
+
+        load_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - load_start).count();
+    }
+}
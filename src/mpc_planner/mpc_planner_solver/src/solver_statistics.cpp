@@ -0,0 +1,142 @@
+#include <mpc_planner_solver/solver_statistics.h>
+
+#include <ros_tools/logging.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace MPCPlanner
+{
+    void SolverStatistics::record(const SolveRecord &record)
+    {
+        uint64_t index = _num_recorded.load(std::memory_order_relaxed);
+        Slot &slot = _slots[index % CAPACITY];
+
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &record, sizeof(SolveRecord));
+
+        uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed); // Odd: being written
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (int i = 0; i < WORDS; i++)
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        _num_recorded.store(index + 1, std::memory_order_release);
+    }
+
+    bool SolverStatistics::read(uint64_t index, SolveRecord &record) const
+    {
+        const Slot &slot = _slots[index % CAPACITY];
+
+        uint64_t words[WORDS];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence % 2 == 1)
+            return false;
+
+        for (int i = 0; i < WORDS; i++)
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+            return false; // Overwritten while reading
+
+        std::memcpy(&record, words, sizeof(SolveRecord));
+        return true;
+    }
+
+    std::vector<SolveRecord> SolverStatistics::getRecords(int window) const
+    {
+        uint64_t end = numRecorded();
+        uint64_t count = std::min<uint64_t>(end, (uint64_t)std::max(0, std::min(window, CAPACITY)));
+
+        std::vector<SolveRecord> records;
+        records.reserve(count);
+
+        SolveRecord record;
+        for (uint64_t index = end - count; index < end; index++)
+        {
+            if (read(index, record))
+                records.push_back(record);
+        }
+        return records;
+    }
+
+    SolverStatistics::Percentiles SolverStatistics::getPercentiles(Field field, int window) const
+    {
+        std::vector<SolveRecord> records = getRecords(window);
+
+        std::vector<double> values;
+        values.reserve(records.size());
+        for (auto &record : records)
+        {
+            switch (field)
+            {
+            case Field::WALL_TIME:
+                values.push_back(record.wall_time);
+                break;
+            case Field::TIME_TOT:
+                values.push_back(record.time_tot);
+                break;
+            case Field::TIME_LIN:
+                values.push_back(record.time_lin);
+                break;
+            case Field::TIME_QP:
+                values.push_back(record.time_qp);
+                break;
+            case Field::SQP_ITER:
+                values.push_back(record.sqp_iter);
+                break;
+            case Field::QP_ITER:
+                values.push_back(record.qp_iter);
+                break;
+            }
+        }
+
+        Percentiles result;
+        result.samples = values.size();
+        if (values.empty())
+            return result;
+
+        // Nearest rank
+        auto percentile = [&](double p)
+        {
+            size_t rank = std::min(values.size() - 1, (size_t)(p * (double)values.size()));
+            std::nth_element(values.begin(), values.begin() + rank, values.end());
+            return values[rank];
+        };
+        result.p50 = percentile(0.50);
+        result.p95 = percentile(0.95);
+        result.p99 = percentile(0.99);
+        return result;
+    }
+
+    void SolverStatistics::print(int window) const
+    {
+        auto print_field = [&](const std::string &name, Field field, double scale)
+        {
+            Percentiles percentiles = getPercentiles(field, window);
+            LOG_VALUE(name + " p50 / p95 / p99", percentiles.p50 * scale << " / " << percentiles.p95 * scale << " / " << percentiles.p99 * scale);
+        };
+
+        LOG_HEADER("Solver Statistics (" << std::min<uint64_t>(numRecorded(), window) << " solves)");
+        print_field("Wall time [ms]", Field::WALL_TIME, 1000.);
+        print_field("Solve time [ms]", Field::TIME_TOT, 1000.);
+        print_field("Linearization time [ms]", Field::TIME_LIN, 1000.);
+        print_field("QP time [ms]", Field::TIME_QP, 1000.);
+        print_field("SQP iterations", Field::SQP_ITER, 1.);
+        print_field("QP iterations", Field::QP_ITER, 1.);
+    }
+
+    void SolverStatistics::dump(std::ostream &out, int window) const
+    {
+        out << "cycle,solver_id,wall_time,time_tot,time_lin,time_qp,sqp_iter,qp_iter,exit_code,warm_start\n";
+        for (auto &record : getRecords(window))
+        {
+            out << record.cycle << "," << record.solver_id << ","
+                << record.wall_time << "," << record.time_tot << "," << record.time_lin << "," << record.time_qp << ","
+                << record.sqp_iter << "," << record.qp_iter << "," << record.exit_code << "," << record.warm_start << "\n";
+        }
+    }
+}
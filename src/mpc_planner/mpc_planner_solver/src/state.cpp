@@ -2,43 +2,55 @@
 
 #include <ros_tools/logging.h>
 
+#include <stdexcept>
+
 using namespace MPCPlanner;
 
+namespace
+{
+    int checkedVarIndex(const std::string &var_name)
+    {
+        int index = Layout::varIndex(var_name);
+        if (index < 0)
+            throw std::out_of_range("Variable \"" + var_name + "\" is not in the solver layout");
+        return index;
+    }
+}
+
 State::State()
 {
-    loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "solver_settings"), _config);
-    loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "model_map"), _model_map);
     initialize();
 }
 
 void State::initialize()
 {
-    _state = std::vector<double>(_config["nx"].as<int>(), 0.0);
-    _nu = _config["nu"].as<int>();
+    _state.fill(0.);
 }
 
 double State::get(std::string &&var_name) const
 {
-    return _state[_model_map[var_name][1].as<int>() - _nu]; // States come after the inputs
+    return get(var_name);
+}
+
+double State::get(const std::string &var_name) const
+{
+    return get(checkedVarIndex(var_name)); // States come after the inputs
 }
 
 Eigen::Vector2d State::getPos() const
 {
-    return Eigen::Vector2d(get("x"), get("y"));
+    return Eigen::Vector2d(get(Layout::Var::X), get(Layout::Var::Y));
 }
 
 void State::set(std::string &&var_name, double value)
 {
-    _state[_model_map[var_name][1].as<int>() - _nu] = value;
+    set(checkedVarIndex(var_name), value);
 }
 
 void State::print() const
 {
-    for (YAML::const_iterator it = _model_map.begin(); it != _model_map.end(); ++it)
+    for (int i = Layout::NUM_INPUTS; i < Layout::NUM_VARIABLES; i++)
     {
-        if (it->second[0].as<std::string>() == "x")
-        {
-            LOG_VALUE(it->first.as<std::string>(), get(it->first.as<std::string>()));
-        }
+        LOG_VALUE(std::string(Layout::VAR_NAMES[i]), get(i));
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,69 @@
+#include <mpc_planner_solver/worker_pool.h>
+
+#include <algorithm>
+
+namespace MPCPlanner
+{
+    WorkerPool::WorkerPool(int num_workers)
+    {
+        for (int i = 0; i < std::max(num_workers, 1); i++)
+            _workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _start_cv.notify_all();
+
+        for (auto &worker : _workers)
+            worker.join();
+    }
+
+    void WorkerPool::workerLoop()
+    {
+        int generation = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _start_cv.wait(lock, [&]()
+                               { return _stop || _generation != generation; });
+                if (_stop)
+                    return;
+
+                generation = _generation;
+            }
+
+            // Take tasks until all are taken
+            for (int i = _next_task++; i < _num_tasks; i = _next_task++)
+                (*_task)(i);
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _finished_workers++;
+            }
+            _done_cv.notify_one();
+        }
+    }
+
+    void WorkerPool::run(int num_tasks, const std::function<void(int)> &task)
+    {
+        if (num_tasks <= 0)
+            return;
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _task = &task;
+        _num_tasks = num_tasks;
+        _next_task = 0;
+        _finished_workers = 0;
+        _generation++;
+        _start_cv.notify_all();
+
+        _done_cv.wait(lock, [&]()
+                      { return _finished_workers == (int)_workers.size(); });
+        _task = nullptr;
+    }
+}
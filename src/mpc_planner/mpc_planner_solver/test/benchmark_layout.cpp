@@ -0,0 +1,109 @@
+/**
+ * @file benchmark_layout.cpp
+ * @brief Compares variable and parameter lookups through the YAML maps with the generated compile-time layout
+ * (mpc_planner_layout.h). The access pattern mimics writing the warmstart and parameters of one planning iteration.
+ */
+#include <mpc_planner_solver/mpc_planner_layout.h>
+
+#include <mpc_planner_util/load_yaml.hpp>
+
+#include <ros_tools/profiling.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace MPCPlanner;
+
+constexpr int REPETITIONS = 10000;
+
+int main()
+{
+    YAML::Node model_map, parameter_map;
+    loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "model_map"), model_map);
+    loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "parameter_map"), parameter_map);
+
+    std::vector<std::string> var_names;
+    for (auto &name : Layout::VAR_NAMES)
+        var_names.emplace_back(name);
+
+    std::vector<std::string> param_names;
+    for (auto &entry : Layout::PARAM_TABLE)
+        param_names.emplace_back(entry.name);
+
+    std::vector<double> x0(Layout::NUM_VARIABLES * (Layout::N + 1), 0.);
+    std::vector<double> params(Layout::NUM_PARAMETERS * Layout::N, 0.);
+    double checksum = 0.;
+
+    auto &yaml_vars = BENCHMARKERS.getBenchmarker("variables (YAML map)");
+    auto &string_vars = BENCHMARKERS.getBenchmarker("variables (layout, by name)");
+    auto &typed_vars = BENCHMARKERS.getBenchmarker("variables (layout, typed)");
+    auto &yaml_params = BENCHMARKERS.getBenchmarker("parameters (YAML map)");
+    auto &string_params = BENCHMARKERS.getBenchmarker("parameters (layout, by name)");
+    auto &typed_params = BENCHMARKERS.getBenchmarker("parameters (layout, typed)");
+
+    for (int r = 0; r < REPETITIONS; r++)
+    {
+        // Variables: one warmstart of all stages
+        yaml_vars.start();
+        for (int k = 0; k <= Layout::N; k++)
+        {
+            for (auto &name : var_names)
+                x0[k * Layout::NUM_VARIABLES + model_map[name][1].as<int>()] += 1.;
+        }
+        yaml_vars.stop();
+
+        string_vars.start();
+        for (int k = 0; k <= Layout::N; k++)
+        {
+            for (auto &name : var_names)
+                x0[k * Layout::NUM_VARIABLES + Layout::varIndex(name)] += 1.;
+        }
+        string_vars.stop();
+
+        typed_vars.start();
+        for (int k = 0; k <= Layout::N; k++)
+        {
+            for (int i = 0; i < Layout::NUM_VARIABLES; i++)
+                x0[k * Layout::NUM_VARIABLES + i] += 1.;
+        }
+        typed_vars.stop();
+
+        // Parameters: all parameters of all stages (only a fraction of the repetitions, the YAML version is slow)
+        if (r % 100 != 0)
+            continue;
+
+        yaml_params.start();
+        for (int k = 0; k < Layout::N; k++)
+        {
+            for (auto &name : param_names)
+                params[k * Layout::NUM_PARAMETERS + parameter_map[name].as<int>()] += 1.;
+        }
+        yaml_params.stop();
+
+        string_params.start();
+        for (int k = 0; k < Layout::N; k++)
+        {
+            for (auto &name : param_names)
+                params[k * Layout::NUM_PARAMETERS + Layout::paramIndex(name)] += 1.;
+        }
+        string_params.stop();
+
+        typed_params.start();
+        for (int k = 0; k < Layout::N; k++)
+        {
+            for (auto &entry : Layout::PARAM_TABLE)
+                params[k * Layout::NUM_PARAMETERS + entry.index] += 1.;
+        }
+        typed_params.stop();
+    }
+
+    for (auto &value : x0)
+        checksum += value;
+    for (auto &value : params)
+        checksum += value;
+
+    BENCHMARKERS.print();
+    std::cout << "checksum: " << checksum << std::endl;
+    return 0;
+}
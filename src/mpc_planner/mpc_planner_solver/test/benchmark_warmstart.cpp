@@ -0,0 +1,146 @@
+/**
+ * @file benchmark_warmstart.cpp
+ * @brief Compares the per-variable warmstart initialization (through the YAML model map and through the layout) with
+ * the block copies in Solver::initializeWarmstart and the vectorized Solver::initializeWithBraking.
+ * Usage: benchmark_warmstart [settings.yaml] (default: the rosnavigation settings)
+ */
+#include <mpc_planner_solver/acados_solver_interface.h>
+#include <mpc_planner_solver/state.h>
+
+#include <mpc_planner_util/load_yaml.hpp>
+#include <mpc_planner_util/parameters.h>
+
+#include <ros_tools/profiling.h>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+using namespace MPCPlanner;
+
+constexpr int REPETITIONS = 100000;
+
+// The shift before the block copies: every variable looked up by name in the model map
+void shiftWithModelMap(Solver &solver, const State &state)
+{
+    for (int k = 0; k < solver.N; k++)
+    {
+        for (YAML::const_iterator it = solver._model_map.begin(); it != solver._model_map.end(); ++it)
+        {
+            std::string name = it->first.as<std::string>();
+            int index = it->second[1].as<int>();
+            if (k == 0)
+                solver.setEgoPrediction(0, index, Layout::isState(index) ? state.get(name) : solver.getOutput(1, index));
+            else if (k == solver.N - 1)
+                solver.setEgoPrediction(k, index, solver.getOutput(k, index));
+            else
+                solver.setEgoPrediction(k, index, solver.getOutput(k + 1, index));
+        }
+    }
+}
+
+// The shift with one setter and getter per variable
+void shiftPerVariable(Solver &solver, const State &state)
+{
+    for (int k = 0; k <= solver.N; k++)
+    {
+        for (int i = 0; i < Layout::NUM_VARIABLES; i++)
+        {
+            if (k == 0)
+                solver.setEgoPrediction(0, i, Layout::isState(i) ? state.get(i) : solver.getOutput(1, i));
+            else if (k >= solver.N - 1)
+                solver.setEgoPrediction(k, i, solver.getOutput(solver.N - 1, i));
+            else
+                solver.setEgoPrediction(k, i, solver.getOutput(k + 1, i));
+        }
+    }
+}
+
+// The braking rollout with one setter per variable and stage
+void brakePerVariable(Solver &solver, const State &state, double deceleration)
+{
+    double x = state.get(Layout::Var::X), y = state.get(Layout::Var::Y), psi = state.get(Layout::Var::PSI);
+    double v = state.get(Layout::Var::V), spline = state.get(Layout::Var::SPLINE);
+
+    for (int k = 0; k <= solver.N; k++)
+    {
+        if (k > 0)
+        {
+            double step = solver.getTimeStep(k - 1);
+            x += v * step * std::cos(psi);
+            y += v * step * std::sin(psi);
+            spline += v * step;
+            v = std::max(v - deceleration * step, 0.);
+        }
+
+        solver.setEgoPrediction(k, Layout::Var::X, x);
+        solver.setEgoPrediction(k, Layout::Var::Y, y);
+        solver.setEgoPrediction(k, Layout::Var::PSI, psi);
+        solver.setEgoPrediction(k, Layout::Var::V, v);
+        solver.setEgoPrediction(k, Layout::Var::SPLINE, spline);
+        solver.setEgoPrediction(k, Layout::Var::A, -deceleration);
+        solver.setEgoPrediction(k, Layout::Var::W, 0.);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::string settings = argc > 1 ? argv[1] : SYSTEM_CONFIG_PATH(__FILE__, "../../mpc_planner_rosnavigation/config/settings");
+    Configuration::getInstance().initialize(settings);
+
+    Solver solver;
+    for (int i = 0; i < Layout::NUM_STATES * (solver.N + 1); i++)
+        solver._output.xtraj[i] = 0.01 * i;
+    for (int i = 0; i < Layout::NUM_INPUTS * solver.N; i++)
+        solver._output.utraj[i] = -0.01 * i;
+
+    State state;
+    state.set(Layout::Var::V, 1.5);
+    state.set(Layout::Var::PSI, 0.3);
+    double deceleration = std::abs(CONFIG["deceleration_at_infeasible"].as<double>());
+
+    auto &model_map = BENCHMARKERS.getBenchmarker("shift (YAML model map)");
+    auto &per_variable = BENCHMARKERS.getBenchmarker("shift (per variable)");
+    auto &block_shift = BENCHMARKERS.getBenchmarker("shift (block copy)");
+    auto &block_keep = BENCHMARKERS.getBenchmarker("keep (block copy)");
+    auto &brake_per_variable = BENCHMARKERS.getBenchmarker("braking (per variable)");
+    auto &brake_vectorized = BENCHMARKERS.getBenchmarker("braking (vectorized)");
+
+    double checksum = 0.;
+    for (int r = 0; r < REPETITIONS; r++)
+    {
+        // The YAML version is slow, only run it for a fraction of the repetitions
+        if (r % 100 == 0)
+        {
+            model_map.start();
+            shiftWithModelMap(solver, state);
+            model_map.stop();
+        }
+
+        per_variable.start();
+        shiftPerVariable(solver, state);
+        per_variable.stop();
+
+        block_shift.start();
+        solver.initializeWarmstart(state, true);
+        block_shift.stop();
+
+        block_keep.start();
+        solver.initializeWarmstart(state, false);
+        block_keep.stop();
+
+        brake_per_variable.start();
+        brakePerVariable(solver, state, deceleration);
+        brake_per_variable.stop();
+        checksum += solver.getEgoPrediction(solver.N, Layout::Var::X);
+
+        brake_vectorized.start();
+        solver.initializeWithBraking(state);
+        brake_vectorized.stop();
+        checksum -= solver.getEgoPrediction(solver.N, Layout::Var::X); // Both rollouts are the same
+    }
+
+    BENCHMARKERS.print();
+    std::cout << "checksum (should be ~0): " << checksum << std::endl;
+    return 0;
+}
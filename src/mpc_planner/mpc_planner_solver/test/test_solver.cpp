@@ -3,10 +3,15 @@
 // Include the header file for the class you want to test
 #include "mpc_planner_solver/state.h"
 #include "mpc_planner_solver/solver_interface.h"
+#include "mpc_planner_solver/worker_pool.h"
+#include "mpc_planner_solver/solver_statistics.h"
+#include "mpc_planner_solver/cycle_scheduler.h"
 
+#include <mpc_planner_types/data_types.h>
 #include <mpc_planner_util/parameters.h>
 
 #include <filesystem>
+#include <thread>
 
 using namespace MPCPlanner;
 
@@ -133,6 +138,313 @@ TEST_F(SolverTest, TestName)
     ASSERT_TRUE(solver2.getParameter(0, "reference_velocity") == 1.);
 }
 
+TEST_F(SolverTest, TimeGrid)
+{
+    Solver solver;
+
+    double time_steps[SOLVER_N];
+    for (int k = 0; k < SOLVER_N; k++)
+        time_steps[k] = k < 5 ? 0.1 : 0.4;
+
+    solver.setTimeSteps(time_steps);
+    ASSERT_FALSE(solver.isTimeGridUniform());
+    ASSERT_NEAR(solver.getStageTime(5), 0.5, 1e-9);
+    ASSERT_NEAR(solver.getStageTime(SOLVER_N), 0.5 + (SOLVER_N - 5) * 0.4, 1e-9);
+
+    // Obstacle predictions (uniform in dt) are interpolated to the stage times
+    Mode mode;
+    for (int k = 0; k < SOLVER_N; k++)
+        mode.emplace_back(Eigen::Vector2d((double)k, 0.), 0., 0., 0.);
+
+    ASSERT_NEAR(interpolatePrediction(mode, solver.getStageTime(5), solver.dt).position(0), 0.5 / solver.dt, 1e-9);
+    ASSERT_NEAR(interpolatePrediction(mode, 3. * solver.dt, solver.dt).position(0), 3., 1e-9);
+    ASSERT_NEAR(interpolatePrediction(mode, 1e3, solver.dt).position(0), SOLVER_N - 1., 1e-9); // Clamped
+
+    // On a fine-to-coarse grid, stage k is compared with the prediction one dt before its stage time
+    for (int k = 0; k < SOLVER_N; k++)
+        time_steps[k] = k < 5 ? 0.1 : 0.3;
+    solver.setTimeSteps(time_steps);
+
+    const double dt = solver.dt;
+    solver.dt = 0.2;
+    ASSERT_NEAR(solver.getPredictionTime(1), 0., 1e-9); // Clamped at the first prediction
+    ASSERT_NEAR(solver.getPredictionTime(5), 0.3, 1e-9);
+    ASSERT_NEAR(solver.getPredictionTime(7), 0.5 + 2 * 0.3 - 0.2, 1e-9); // Not the time of stage 6 (0.8)
+    ASSERT_NEAR(interpolatePrediction(mode, solver.getPredictionTime(7), solver.dt).position(0), 0.9 / 0.2, 1e-9);
+    solver.dt = dt;
+
+    solver.setUniformTimeSteps(solver.dt);
+    ASSERT_TRUE(solver.isTimeGridUniform());
+    for (int k = 1; k < SOLVER_N; k++)
+        ASSERT_NEAR(solver.getPredictionTime(k), solver.getStageTime(k - 1), 1e-9);
+}
+
+TEST_F(SolverTest, WarmstartShift)
+{
+    Solver solver;
+    for (int i = 0; i < Layout::NUM_STATES * (solver.N + 1); i++)
+        solver._output.xtraj[i] = i;
+    for (int i = 0; i < Layout::NUM_INPUTS * solver.N; i++)
+        solver._output.utraj[i] = -i;
+
+    State state;
+    state.set(Layout::Var::X, 0.5);
+
+    solver.initializeWarmstart(state, true);
+    ASSERT_EQ(solver.getEgoPrediction(0, Layout::Var::X), 0.5);                              // Initial state
+    ASSERT_EQ(solver.getEgoPrediction(0, Layout::Var::W), solver.getOutput(1, Layout::Var::W)); // Shifted input
+    ASSERT_EQ(solver.getEgoPrediction(3, Layout::Var::Y), solver.getOutput(4, Layout::Var::Y));
+    ASSERT_EQ(solver.getEgoPrediction(solver.N, Layout::Var::Y), solver.getOutput(solver.N, Layout::Var::Y)); // Hold
+
+    solver.initializeWarmstart(state, false);
+    for (int k = 0; k <= solver.N; k++)
+        ASSERT_EQ(solver.getEgoPrediction(k, Layout::Var::PSI), solver.getOutput(k, Layout::Var::PSI));
+
+    // Braking from 1 m/s stops and stays at rest
+    state.set(Layout::Var::V, 1.);
+    solver.initializeWithBraking(state);
+    ASSERT_EQ(solver.getEgoPrediction(0, Layout::Var::V), 1.);
+    ASSERT_EQ(solver.getEgoPrediction(solver.N, Layout::Var::V), 0.);
+    ASSERT_NEAR(solver.getEgoPrediction(1, Layout::Var::X), 0.5 + solver.getTimeStep(0), 1e-9);
+    ASSERT_GE(solver.getEgoPrediction(solver.N, Layout::Var::X), solver.getEgoPrediction(solver.N - 1, Layout::Var::X));
+}
+
+TEST(LayoutTest, MatchesGeneratedMaps)
+{
+    YAML::Node model_map, parameter_map;
+    loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "model_map"), model_map);
+    loadConfigYaml(SYSTEM_CONFIG_PATH(__FILE__, "parameter_map"), parameter_map);
+
+    for (YAML::const_iterator it = model_map.begin(); it != model_map.end(); ++it)
+    {
+        int index = Layout::varIndex(it->first.as<std::string>());
+        ASSERT_EQ(index, it->second[1].as<int>());
+        ASSERT_EQ(Layout::isState(index), it->second[0].as<std::string>() == "x");
+    }
+
+    for (YAML::const_iterator it = parameter_map.begin(); it != parameter_map.end(); ++it)
+    {
+        if (it->first.as<std::string>() == "num parameters")
+            ASSERT_EQ(Layout::NUM_PARAMETERS, it->second.as<int>());
+        else
+            ASSERT_EQ(Layout::paramIndex(it->first.as<std::string>()), it->second.as<int>());
+    }
+    ASSERT_EQ(Layout::paramIndex("not_a_parameter"), -1);
+}
+
+TEST(AcadosParametersTest, DirtyStages)
+{
+    AcadosParameters params;
+    for (int k = 0; k < SOLVER_N; k++)
+    {
+        ASSERT_TRUE(params.isDirty(k)); // Everything needs to be uploaded initially
+        params.markClean(k);
+    }
+
+    params.set(3, 5, 0.); // Unchanged value
+    ASSERT_FALSE(params.isDirty(3));
+
+    params.set(3, 5, 1.);
+    params.set(3, 2, 1.);
+    ASSERT_TRUE(params.isDirty(3));
+    ASSERT_EQ(params.dirty_begin[3], 2);
+    ASSERT_EQ(params.dirty_end[3], 6);
+    ASSERT_FALSE(params.isDirty(4));
+
+    // Blocks only mark the values that changed
+    double block[4] = {0., 7., 8., 0.};
+    params.setBlock(4, 10, block, 4);
+    ASSERT_EQ(params.dirty_begin[4], 11);
+    ASSERT_EQ(params.dirty_end[4], 13);
+    ASSERT_EQ(params.all_parameters[4 * SOLVER_NP + 12], 8.);
+
+    params.markClean(4);
+    params.setBlock(4, 10, block, 4);
+    ASSERT_FALSE(params.isDirty(4));
+}
+
+TEST(WorkerPoolTest, RunsEveryTaskOnce)
+{
+    WorkerPool workers(3);
+
+    for (int repeat = 0; repeat < 10; repeat++) // The workers are reused
+    {
+        std::vector<int> counts(17, 0);
+        workers.run(counts.size(), [&](int i)
+                    { counts[i]++; });
+
+        for (auto &count : counts)
+            ASSERT_EQ(count, 1);
+    }
+}
+
+TEST(SolverStatisticsTest, PercentilesOverWindow)
+{
+    SolverStatistics statistics;
+
+    // More records than fit: the oldest are overwritten
+    int num_records = SolverStatistics::CAPACITY + 100;
+    for (int i = 0; i < num_records; i++)
+    {
+        SolveRecord record;
+        record.cycle = i;
+        record.wall_time = (double)(i % 100);
+        record.sqp_iter = i;
+        statistics.record(record);
+    }
+
+    ASSERT_EQ(statistics.numRecorded(), (uint64_t)num_records);
+
+    std::vector<SolveRecord> records = statistics.getRecords();
+    ASSERT_EQ((int)records.size(), SolverStatistics::CAPACITY);
+    ASSERT_EQ(records.front().cycle, (uint64_t)(num_records - SolverStatistics::CAPACITY));
+    ASSERT_EQ(records.back().cycle, (uint64_t)(num_records - 1));
+
+    auto wall_time = statistics.getPercentiles(SolverStatistics::Field::WALL_TIME, 100); // 0, ..., 99 once each
+    ASSERT_EQ(wall_time.samples, 100);
+    ASSERT_DOUBLE_EQ(wall_time.p50, 50.);
+    ASSERT_DOUBLE_EQ(wall_time.p95, 95.);
+    ASSERT_DOUBLE_EQ(wall_time.p99, 99.);
+
+    auto sqp_iter = statistics.getPercentiles(SolverStatistics::Field::SQP_ITER, 1);
+    ASSERT_DOUBLE_EQ(sqp_iter.p99, num_records - 1.);
+}
+
+namespace
+{
+    double seconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double>(duration).count();
+    }
+
+    // Expected post-processing time of the scheduler [s]
+    double postProcessingEstimate(const CycleScheduler &scheduler, const CycleScheduler::Settings &settings)
+    {
+        return seconds(scheduler.getDeadline() - scheduler.getSolverDeadline()) - settings.margin;
+    }
+}
+
+TEST(CycleSchedulerTest, Deadline)
+{
+    CycleScheduler::Settings settings;
+    settings.control_period = 0.05;
+    settings.margin = 0.003;
+    CycleScheduler scheduler(settings, 10);
+
+    // 20 ms of the period were used before the cycle started
+    auto now = std::chrono::steady_clock::now();
+    scheduler.startCycle(std::chrono::system_clock::now() - std::chrono::milliseconds(20));
+
+    double time_left = seconds(scheduler.getDeadline() - now);
+    ASSERT_GT(time_left, 0.025);
+    ASSERT_LE(time_left, 0.030 + 1e-3);
+
+    // Nothing was post-processed yet, only the margin is kept free
+    ASSERT_NEAR(postProcessingEstimate(scheduler, settings), 0., 1e-6);
+    ASSERT_LE(scheduler.getSolverBudget(), time_left - settings.margin);
+    ASSERT_GT(scheduler.getSolverBudget(), 0.020);
+
+    ASSERT_EQ(scheduler.getIterationLimit(), 10); // Not adapted
+}
+
+TEST(CycleSchedulerTest, PostProcessingEstimateDecays)
+{
+    CycleScheduler::Settings settings;
+    settings.control_period = 0.1;
+    CycleScheduler scheduler(settings, 10);
+
+    // A slow post-processing is expected in the next cycle
+    scheduler.startCycle(std::chrono::system_clock::now());
+    scheduler.startPhase(CycleScheduler::Phase::POST_PROCESSING);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    scheduler.endCycle();
+
+    scheduler.startCycle(std::chrono::system_clock::now());
+    double estimate = postProcessingEstimate(scheduler, settings);
+    ASSERT_GE(estimate, 0.010);
+
+    // Fast post-processing: the estimate decays by 10% per cycle
+    for (int cycle = 0; cycle < 5; cycle++)
+    {
+        scheduler.startPhase(CycleScheduler::Phase::POST_PROCESSING);
+        scheduler.endCycle();
+
+        scheduler.startCycle(std::chrono::system_clock::now());
+        ASSERT_NEAR(postProcessingEstimate(scheduler, settings), 0.9 * estimate, 1e-6);
+        estimate *= 0.9;
+    }
+    scheduler.endCycle();
+}
+
+TEST(CycleSchedulerTest, IntegralIterationCap)
+{
+    CycleScheduler::Settings settings;
+    settings.control_period = 0.02;
+    settings.margin = 0.;
+    settings.adapt_iterations = true;
+    settings.target_utilization = 0.8;
+    settings.gain = 0.5;
+    CycleScheduler scheduler(settings, 10);
+    ASSERT_EQ(scheduler.getIterationLimit(), 10);
+
+    auto run_cycle = [&](std::chrono::milliseconds solve_time)
+    {
+        scheduler.startCycle(std::chrono::system_clock::now());
+        scheduler.startPhase(CycleScheduler::Phase::SOLVE);
+        std::this_thread::sleep_for(solve_time);
+        scheduler.onSolved();
+        scheduler.endCycle();
+    };
+
+    // Solves that use more than the budget lower the cap each cycle, down to one iteration
+    int previous_limit = scheduler.getIterationLimit();
+    for (int cycle = 0; cycle < 6; cycle++)
+    {
+        run_cycle(std::chrono::milliseconds(25));
+        ASSERT_LT(scheduler.getIterationLimit(), previous_limit == 1 ? 2 : previous_limit);
+        previous_limit = scheduler.getIterationLimit();
+    }
+    ASSERT_EQ(scheduler.getIterationLimit(), 1);
+
+    // Fast solves raise it again (by up to gain * target * max per cycle), up to the generated iterations
+    run_cycle(std::chrono::milliseconds(0));
+    ASSERT_GT(scheduler.getIterationLimit(), 1);
+    ASSERT_LE(scheduler.getIterationLimit(), 5);
+    for (int cycle = 0; cycle < 3; cycle++)
+        run_cycle(std::chrono::milliseconds(0));
+    ASSERT_EQ(scheduler.getIterationLimit(), 10);
+}
+
+TEST(CycleSchedulerTest, CountsDeadlineMisses)
+{
+    CycleScheduler::Settings settings;
+    settings.control_period = 0.01;
+    CycleScheduler scheduler(settings, 10);
+
+    scheduler.endCycle(); // No cycle was started
+    ASSERT_EQ(scheduler.numCycles(), 0);
+
+    scheduler.startCycle(std::chrono::system_clock::now());
+    scheduler.endCycle();
+    ASSERT_EQ(scheduler.numCycles(), 1);
+    ASSERT_EQ(scheduler.numDeadlineMisses(), 0);
+
+    scheduler.startCycle(std::chrono::system_clock::now());
+    std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    scheduler.endCycle();
+    ASSERT_EQ(scheduler.numDeadlineMisses(), 1);
+
+    // The whole period was used before the cycle started
+    scheduler.startCycle(std::chrono::system_clock::now() - std::chrono::milliseconds(20));
+    ASSERT_LT(scheduler.getSolverBudget(), 0.);
+    scheduler.endCycle();
+    ASSERT_EQ(scheduler.numCycles(), 3);
+    ASSERT_EQ(scheduler.numDeadlineMisses(), 2);
+
+    scheduler.endCycle(); // Already ended
+    ASSERT_EQ(scheduler.numCycles(), 3);
+}
+
 // Run all the tests
 int main(int argc, char **argv)
 {
@@ -55,6 +55,10 @@ namespace MPCPlanner
 
     typedef std::vector<PredictionStep> Mode;
 
+    /** @brief The prediction of a mode at time [s], where step i of the mode is at time i * dt. Linearly interpolates
+     * between steps and clamps to the first and last step */
+    PredictionStep interpolatePrediction(const Mode &mode, double time, double dt);
+
     struct Prediction
     {
 
@@ -121,6 +125,9 @@ namespace MPCPlanner
 
         void add(const Eigen::Vector2d &p);
         void add(const double x, const double y);
+
+        /** @brief Remove all positions, keeping the allocated memory */
+        void clear();
     };
 
     struct FixedSizeTrajectory
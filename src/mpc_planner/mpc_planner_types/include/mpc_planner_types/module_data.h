@@ -20,6 +20,19 @@ namespace MPCPlanner
 {
     struct ModuleData
     {
+        /** @brief Shared results that modules produce and consume in update() (bit flags, see ControllerModule::produces()) */
+        enum Field : unsigned int
+        {
+            NONE = 0,
+            STATIC_OBSTACLES = 1 << 0,
+            PATH = 1 << 1,
+            PATH_WIDTH = 1 << 2, // path_width_left and path_width_right
+            PATH_VELOCITY = 1 << 3,
+            CURRENT_PATH_SEGMENT = 1 << 4,
+            STATE = 1 << 5, // State variables computed by modules (e.g., the spline progress)
+            ALL = ~0u
+        };
+
         std::vector<StaticObstacle> static_obstacles;
 
         // These are shared between different modules
@@ -30,6 +43,9 @@ namespace MPCPlanner
 
         int current_path_segment{-1};
 
+        double road_width{0.}; // Width of the road along the path, with PATH [m] (0: unknown, use road.width)
+
+        /** @brief Reset for a new planning iteration. Keeps the stages and memory of static_obstacles, but clears them */
         void reset();
     };
 }
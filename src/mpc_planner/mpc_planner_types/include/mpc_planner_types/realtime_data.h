@@ -33,6 +33,7 @@ namespace MPCPlanner
         double intrusion;
 
         std::chrono::system_clock::time_point planning_start_time;
+        std::chrono::steady_clock::time_point solver_deadline; // Set by the planner (CycleScheduler) before the solve
 
         RealTimeData() = default;
 
@@ -1,5 +1,8 @@
 #include "mpc_planner_types/data_types.h"
 
+#include <algorithm>
+#include <cmath>
+
 /** Basic high-level data types for motion planning */
 
 namespace MPCPlanner
@@ -30,6 +33,27 @@ namespace MPCPlanner
     {
     }
 
+    PredictionStep interpolatePrediction(const Mode &mode, double time, double dt)
+    {
+        double index = std::max(time / dt, 0.);
+        int lower = std::min((int)std::floor(index + 1e-9), (int)mode.size() - 1); // Tolerance to hit steps exactly on a uniform grid
+        if (lower == (int)mode.size() - 1)
+            return mode[lower];
+
+        double alpha = std::max(index - (double)lower, 0.);
+        if (alpha < 1e-9)
+            return mode[lower];
+
+        const PredictionStep &a = mode[lower];
+        const PredictionStep &b = mode[lower + 1];
+        double angle_diff = std::atan2(std::sin(b.angle - a.angle), std::cos(b.angle - a.angle)); // Shortest rotation
+
+        return PredictionStep(a.position + alpha * (b.position - a.position),
+                              a.angle + alpha * angle_diff,
+                              a.major_radius + alpha * (b.major_radius - a.major_radius),
+                              a.minor_radius + alpha * (b.minor_radius - a.minor_radius));
+    }
+
     Prediction::Prediction()
         : type(PredictionType::NONE)
     {
@@ -94,6 +118,11 @@ namespace MPCPlanner
         positions.push_back(Eigen::Vector2d(x, y));
     }
 
+    void Trajectory::clear()
+    {
+        positions.clear();
+    }
+
     FixedSizeTrajectory::FixedSizeTrajectory(int size)
         : _size(size)
     {
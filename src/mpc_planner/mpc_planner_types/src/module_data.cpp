@@ -4,10 +4,14 @@ namespace MPCPlanner
 {
         void ModuleData::reset()
         {
+                for (auto &stage_obstacles : static_obstacles)
+                        stage_obstacles.clear();
+
                 path.reset();
                 path_width_left.reset();
                 path_width_right.reset();
                 path_velocity.reset();
                 current_path_segment = -1;
+                road_width = 0.;
         }
 }
\ No newline at end of file
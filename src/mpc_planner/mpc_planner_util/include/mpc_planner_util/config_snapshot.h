@@ -0,0 +1,145 @@
+#ifndef CONFIG_SNAPSHOT_H
+#define CONFIG_SNAPSHOT_H
+
+#include <yaml-cpp/yaml.h>
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Typed copy of the settings that are read while planning. Built from the YAML once and never modified after
+ * it is published, changes (e.g., from reconfigure) publish a new snapshot (see Configuration::update).
+ */
+struct ConfigSnapshot
+{
+    bool debug_output{false};
+    bool debug_visuals{false};
+    bool enable_output{true};
+    bool shift_previous_solution_forward{false};
+
+    int N{0};
+    double integrator_step{0.};
+    double control_frequency{0.};
+    double deceleration_at_infeasible{0.};
+
+    int n_discs{1};
+    double robot_radius{0.};
+    double robot_length{0.};
+    double robot_width{0.};
+
+    unsigned int max_obstacles{0};
+    double max_obstacle_distance{std::numeric_limits<double>::infinity()};
+    double obstacle_radius{0.};
+
+    bool probabilistic{false};
+    double risk{0.};
+
+    double road_width{0.}; // As configured, the width of the current road is in ModuleData::road_width
+    int draw_every{1};
+
+    bool warmstart_with_mpc_solution{false}; // t-mpc
+    bool highlight_selected{false};          // t-mpc
+
+    /** @brief All entries of "weights", in the order of weight_names (a weight keeps its index in later snapshots) */
+    std::vector<std::string> weight_names;
+    std::vector<double> weights;
+
+    ConfigSnapshot() = default;
+
+    explicit ConfigSnapshot(const YAML::Node &config)
+    {
+        read(config, "debug_output", debug_output);
+        read(config, "debug_visuals", debug_visuals);
+        read(config, "enable_output", enable_output);
+        read(config, "shift_previous_solution_forward", shift_previous_solution_forward);
+
+        read(config, "N", N);
+        read(config, "integrator_step", integrator_step);
+        read(config, "control_frequency", control_frequency);
+        read(config, "deceleration_at_infeasible", deceleration_at_infeasible);
+
+        read(config, "n_discs", n_discs);
+        read(config, "robot_radius", robot_radius);
+        if (config["robot"])
+        {
+            read(config["robot"], "length", robot_length);
+            read(config["robot"], "width", robot_width);
+        }
+
+        read(config, "max_obstacles", max_obstacles);
+        read(config, "max_obstacle_distance", max_obstacle_distance);
+        read(config, "obstacle_radius", obstacle_radius);
+
+        if (config["probabilistic"])
+        {
+            read(config["probabilistic"], "enable", probabilistic);
+            read(config["probabilistic"], "risk", risk);
+        }
+
+        if (config["road"])
+            read(config["road"], "width", road_width);
+
+        if (config["visualization"])
+            read(config["visualization"], "draw_every", draw_every);
+
+        if (config["t-mpc"])
+        {
+            read(config["t-mpc"], "warmstart_with_mpc_solution", warmstart_with_mpc_solution);
+            read(config["t-mpc"], "highlight_selected", highlight_selected);
+        }
+
+        if (config["weights"])
+        {
+            for (const auto &weight : config["weights"])
+            {
+                weight_names.push_back(weight.first.as<std::string>());
+                weights.push_back(weight.second.as<double>());
+            }
+        }
+    }
+
+    /** @brief Index of a weight in weights, -1 if it is not in the settings */
+    int weightIndex(const char *name) const
+    {
+        for (size_t i = 0; i < weight_names.size(); i++)
+        {
+            if (std::strcmp(weight_names[i].c_str(), name) == 0)
+                return (int)i;
+        }
+        return -1;
+    }
+
+    /** @brief A weight by name (does not allocate, throws if the weight is not in the settings) */
+    double weight(const char *name) const
+    {
+        int index = weightIndex(name);
+        if (index < 0)
+            throw std::out_of_range(std::string("Weight \"") + name + "\" is not in the settings");
+
+        return weights[index];
+    }
+
+    /** @brief Set a weight by name (before publishing), returns false if it is not in the settings */
+    bool setWeight(const char *name, double value)
+    {
+        int index = weightIndex(name);
+        if (index < 0)
+            return false;
+
+        weights[index] = value;
+        return true;
+    }
+
+private:
+    template <typename T>
+    static void read(const YAML::Node &node, const char *key, T &value)
+    {
+        if (node[key])
+            value = node[key].as<T>();
+    }
+};
+
+#endif // CONFIG_SNAPSHOT_H
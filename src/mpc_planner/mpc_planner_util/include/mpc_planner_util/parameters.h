@@ -2,14 +2,23 @@
 #define PARAMETERS_H
 
 #include <mpc_planner_util/load_yaml.hpp>
+#include <mpc_planner_util/config_snapshot.h>
 #include <ros_tools/logging.h>
 
-#define LOG_MARK(x)                        \
-    if (CONFIG["debug_output"].as<bool>()) \
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define LOG_MARK(x)                     \
+    if (CONFIG_SNAPSHOT.debug_output) \
     LOG_HOOK_MSG(x)
 
 #define CONFIG Configuration::getInstance().getYAMLNode()
 
+/** @brief The current typed settings (lock-free, use in the control loop instead of CONFIG) */
+#define CONFIG_SNAPSHOT Configuration::getInstance().snapshot()
+
 namespace YAML
 {
     class SafeNode
@@ -32,19 +41,56 @@ public:
     void initialize(const std::string &config_file)
     {
         loadConfigYaml(config_file, _config); // Load parameters from the YAML file
+        publish(ConfigSnapshot(_config));
     }
 
+    /** @brief The YAML tree, only read it during initialization (it is not updated at runtime) */
     YAML::Node &getYAMLNode()
     {
         return _config;
     }
 
+    /** @brief The latest snapshot. It stays valid until shutdown, so it can be kept for a whole iteration */
+    const ConfigSnapshot &snapshot() const
+    {
+        return *_snapshot.load(std::memory_order_acquire);
+    }
+
+    /** @brief Publish a modified copy of the latest snapshot, for reconfiguration only (each snapshot is kept until
+     * shutdown). E.g., update([&](ConfigSnapshot &s){ s.setWeight("goal", w); }) */
+    template <typename Modifier>
+    void update(Modifier &&modify)
+    {
+        std::lock_guard<std::mutex> lock(_publish_mutex); // Writers do not overwrite each others changes
+        ConfigSnapshot snapshot = *_snapshot.load(std::memory_order_acquire);
+        modify(snapshot);
+        publishLocked(std::move(snapshot));
+    }
+
 private:
     YAML::Node _config;
 
+    // Readers only load the pointer. Replaced snapshots are kept, because a reader may still use them (they are only
+    // published on initialization and reconfiguration, so this does not grow in the control loop)
+    std::atomic<const ConfigSnapshot *> _snapshot;
+    std::vector<std::unique_ptr<const ConfigSnapshot>> _published;
+    std::mutex _publish_mutex;
+
     Configuration()
     {
-        // Initialize your configuration variables here
+        publish(ConfigSnapshot()); // Defaults until initialize() is called
+    }
+
+    void publish(ConfigSnapshot &&snapshot)
+    {
+        std::lock_guard<std::mutex> lock(_publish_mutex);
+        publishLocked(std::move(snapshot));
+    }
+
+    void publishLocked(ConfigSnapshot &&snapshot)
+    {
+        _published.emplace_back(new ConfigSnapshot(std::move(snapshot)));
+        _snapshot.store(_published.back().get(), std::memory_order_release);
     }
 
     Configuration(const Configuration &) = delete;
@@ -132,7 +132,7 @@ def generate_acados_solver(modules, settings, model, skip_solver_generation):
 
     # qp solver options
     ocp.solver_options.qp_solver = "PARTIAL_CONDENSING_HPIPM"
-    ocp.solver_options.qp_solver_iter_max = 50  # default = 50
+    ocp.solver_options.qp_solver_iter_max = settings["solver_settings"]["acados"].get("qp_iter_max", 50)  # default = 50
     ocp.solver_options.qp_solver_warm_start = 2  # cold start / 1 = warm, 2 = warm primal and dual
 
     # code generation options
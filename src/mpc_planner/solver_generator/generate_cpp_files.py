@@ -3,15 +3,18 @@ import datetime
 
 from util.code_generation import tabs, open_function, close_function, add_zero_below_10
 from util.files import generated_src_file, generated_include_file, solver_name, get_package_path, planner_path, get_current_package
-from util.files import generated_parameter_include_file
+from util.files import generated_parameter_include_file, generated_layout_include_file
 
 from util.logging import print_success, print_path
 
 
-def generate_module_header(modules):
+def generate_module_header(modules, settings):
     path = f"{get_package_path('mpc_planner_modules')}/include/mpc_planner_modules/modules.h"
     print_path("Module Header", path, end="", tab=True)
 
+    # Optionally also define the module set as a type, for the planner to call the modules without virtual dispatch
+    static_modules = settings["solver_settings"].get("static_modules", False)
+
     module_header = open(path, "w")
 
     module_header.write("#ifndef __MPC_PLANNER_GENERATED_MODULES_H__\n")
@@ -20,7 +23,10 @@ def generate_module_header(modules):
         module_header.write(f"#include <mpc_planner_modules/{module.import_name}>\n")
         for source in module.sources:
             module_header.write(f"#include <mpc_planner_modules/{source.split('.')[0]}.h>\n")
-        
+
+    if static_modules:
+        module_header.write("#include <mpc_planner_modules/static_modules.h>\n")
+        module_header.write("\n#define MPC_PLANNER_STATIC_MODULES\n")
 
     module_header.write("\n")
 
@@ -34,6 +40,10 @@ def generate_module_header(modules):
         module_header.write("\t\tmodules.emplace_back(nullptr);\n")
         module_header.write("\t\tmodules.back() = std::make_shared<" + module.module_name + ">(solver);\n")
     module_header.write("\n\t}\n")
+
+    if static_modules:
+        module_names = ", ".join([module.module_name for module in modules.modules])
+        module_header.write(f"\n\tusing GeneratedModules = StaticModules<{module_names}>;\n")
     module_header.write("}")
 
     module_header.write("\n#endif")
@@ -232,6 +242,11 @@ def generate_parameter_cpp_code(settings, model):
 
     cpp_file.write("namespace MPCPlanner{\n\n")
 
+    def write_parameter(index):
+        if settings["solver_settings"]["solver"] == "acados":
+            return f"params.set(k, {index}, value);\n"  # Tracks which stages changed
+        return f"params.all_parameters[k * {settings['params'].length()} + {index}] = value;\n"
+
     for key, indices in settings["params"].parameter_bundles.items():
         function_name = key.replace("_", " ").title().replace(" ", "")
 
@@ -239,7 +254,7 @@ def generate_parameter_cpp_code(settings, model):
             header_file.write(f"void setSolverParameter{function_name}(int k, {param_name}& params, const double value, int index=0);\n")
             cpp_file.write(f"void setSolverParameter{function_name}(int k, {param_name}& params, const double value, int index){{\n")
             cpp_file.write("\t(void)index;\n")
-            cpp_file.write(f"\tparams.all_parameters[k * {settings['params'].length()} + {indices[0]}] = value;\n")
+            cpp_file.write(f"\t{write_parameter(indices[0])}")
         else:
             header_file.write(f"void setSolverParameter{function_name}(int k, {param_name}& params, const double value, int index);\n")
             cpp_file.write(f"void setSolverParameter{function_name}(int k, {param_name}& params, const double value, int index){{\n")
@@ -249,7 +264,7 @@ def generate_parameter_cpp_code(settings, model):
                 else:
                     cpp_file.write(f"\telse if(index == {i})\n")
 
-                cpp_file.write(f"\t\tparams.all_parameters[k * {settings['params'].length()} + {index}] = value;\n")
+                cpp_file.write(f"\t\t{write_parameter(index)}")
 
         cpp_file.write("}\n")
 
@@ -260,6 +275,111 @@ def generate_parameter_cpp_code(settings, model):
     return
 
 
+def _cpp_identifier(name):
+    identifier = "".join(c if c.isalnum() else "_" for c in name).upper()
+    if identifier[0].isdigit():
+        identifier = "_" + identifier
+    return identifier
+
+
+def generate_layout_header(settings, model):
+    """
+    Generates a header with the solver layout as compile-time constants (dimensions, variable and parameter indices).
+    The solver, state and modules use these instead of looking up indices in the YAML maps at runtime.
+    """
+    header_file_name = generated_layout_include_file(settings)
+    header_file = open(header_file_name, "w")
+
+    params = settings["params"]
+    param_map = {name: idx for name, idx in params._params.items() if name != "num parameters"}
+    variables = model.inputs + model.states
+
+    header_file.write(
+        "/** This file was autogenerated by the mpc_planner_solver package at "
+        + datetime.datetime.now().strftime("%I:%M%p on %B %d, %Y")
+        + "*/\n"
+    )
+    header_file.write("#ifndef __MPC_PLANNER_LAYOUT_H__\n")
+    header_file.write("#define __MPC_PLANNER_LAYOUT_H__\n\n")
+    header_file.write("#include <array>\n")
+    header_file.write("#include <string_view>\n\n")
+
+    header_file.write("namespace MPCPlanner\n{\n")
+    header_file.write("namespace Layout\n{\n")
+
+    header_file.write(f"\tconstexpr int N = {settings['N']};\n")
+    header_file.write(f"\tconstexpr int NUM_INPUTS = {model.nu};\n")
+    header_file.write(f"\tconstexpr int NUM_STATES = {model.nx};\n")
+    header_file.write(f"\tconstexpr int NUM_VARIABLES = {model.get_nvar()};\n")
+    header_file.write(f"\tconstexpr int NUM_PARAMETERS = {params.length()};\n\n")
+
+    header_file.write("\tstruct NamedIndex\n\t{\n\t\tstd::string_view name;\n\t\tint index;\n\t};\n\n")
+
+    # Variables
+    header_file.write("\t/** @brief Index of each variable in z = [u, x] */\n")
+    header_file.write("\tnamespace Var\n\t{\n")
+    for idx, var in enumerate(variables):
+        header_file.write(f"\t\tconstexpr int {_cpp_identifier(var)} = {idx};\n")
+    header_file.write("\t}\n\n")
+
+    header_file.write("\tconstexpr std::array<std::string_view, NUM_VARIABLES> VAR_NAMES = {")
+    header_file.write(", ".join(f'"{var}"' for var in variables))
+    header_file.write("};\n")
+    header_file.write("\tconstexpr std::array<double, NUM_VARIABLES> LOWER_BOUND = {")
+    header_file.write(", ".join(f"{float(value)}" for value in model.lower_bound))
+    header_file.write("};\n")
+    header_file.write("\tconstexpr std::array<double, NUM_VARIABLES> UPPER_BOUND = {")
+    header_file.write(", ".join(f"{float(value)}" for value in model.upper_bound))
+    header_file.write("};\n\n")
+
+    # Parameters
+    header_file.write("\t/** @brief Index of each parameter within the parameters of one stage */\n")
+    header_file.write("\tnamespace Param\n\t{\n")
+    for name, idx in param_map.items():
+        header_file.write(f"\t\tconstexpr int {_cpp_identifier(name)} = {idx};\n")
+    header_file.write("\t}\n\n")
+
+    header_file.write("\t/** @brief Indices of the parameters in each bundle (matching the setSolverParameter functions) */\n")
+    header_file.write("\tnamespace Bundle\n\t{\n")
+    for name, indices in params.parameter_bundles.items():
+        header_file.write(
+            f"\t\tconstexpr std::array<int, {len(indices)}> {_cpp_identifier(name)} = {{{', '.join(str(i) for i in indices)}}};\n"
+        )
+    header_file.write("\t}\n\n")
+
+    header_file.write("\t/** @brief Parameter names sorted for lookup by name */\n")
+    header_file.write(f"\tconstexpr std::array<NamedIndex, {len(param_map)}> PARAM_TABLE = {{{{\n")
+    for name in sorted(param_map.keys()):
+        header_file.write(f'\t\t{{"{name}", {param_map[name]}}},\n')
+    header_file.write("\t}};\n\n")
+
+    # Helpers
+    header_file.write("\tconstexpr bool isInput(int var) { return var < NUM_INPUTS; }\n")
+    header_file.write("\tconstexpr bool isState(int var) { return var >= NUM_INPUTS; }\n")
+    header_file.write("\tconstexpr int stateIndex(int var) { return var - NUM_INPUTS; } // Index in xinit / xtraj\n\n")
+
+    header_file.write("\t/** @brief Returns the variable index for a name or -1 if it does not exist */\n")
+    header_file.write("\tconstexpr int varIndex(std::string_view name)\n\t{\n")
+    header_file.write("\t\tfor (int i = 0; i < NUM_VARIABLES; i++)\n\t\t{\n")
+    header_file.write("\t\t\tif (VAR_NAMES[i] == name)\n\t\t\t\treturn i;\n\t\t}\n")
+    header_file.write("\t\treturn -1;\n\t}\n\n")
+
+    header_file.write("\t/** @brief Returns the parameter index for a name or -1 if it does not exist */\n")
+    header_file.write("\tconstexpr int paramIndex(std::string_view name)\n\t{\n")
+    header_file.write("\t\tstd::size_t low = 0, high = PARAM_TABLE.size();\n")
+    header_file.write("\t\twhile (low < high)\n\t\t{\n")
+    header_file.write("\t\t\tstd::size_t mid = (low + high) / 2;\n")
+    header_file.write("\t\t\tif (PARAM_TABLE[mid].name < name)\n\t\t\t\tlow = mid + 1;\n")
+    header_file.write("\t\t\telse\n\t\t\t\thigh = mid;\n\t\t}\n")
+    header_file.write("\t\tif (low < PARAM_TABLE.size() && PARAM_TABLE[low].name == name)\n\t\t\treturn PARAM_TABLE[low].index;\n")
+    header_file.write("\t\treturn -1;\n\t}\n")
+
+    header_file.write("}\n}\n#endif\n")
+    header_file.close()
+
+    print_success(" -> generated")
+
+
 def generate_rqtreconfigure(settings):
     current_package = get_current_package()
     system_name = "".join(current_package.split("_")[2:])
@@ -318,11 +438,15 @@ def generate_rqtreconfigure(settings):
     rqt_header.write("\t\t(void)level;\n")
     rqt_header.write("\t\tif (_first_reconfigure_callback){\n")
     for idx, param in enumerate(rqt_params):
-        rqt_header.write(f'\t\t\tconfig.{param} = CONFIG{settings["params"].rqt_param_config_names[idx](param)}.as<double>();\n')
+        rqt_header.write(f'\t\t\tconfig.{param} = CONFIG_SNAPSHOT.weight("{settings["params"].rqt_param_config_names[idx](param)}");\n')
     rqt_header.write("\t\t\t_first_reconfigure_callback = false;\n")
     rqt_header.write("\t\t}else{\n")
+    rqt_header.write("\t\t\t// Publish a new configuration snapshot (the planner reads the weights without locking)\n")
+    rqt_header.write("\t\t\tConfiguration::getInstance().update([&config](ConfigSnapshot &snapshot)\n")
+    rqt_header.write("\t\t\t{\n")
     for idx, param in enumerate(rqt_params):
-        rqt_header.write(f'\t\t\tCONFIG{settings["params"].rqt_param_config_names[idx](param)} = config.{param};\n')
+        rqt_header.write(f'\t\t\t\tsnapshot.setWeight("{settings["params"].rqt_param_config_names[idx](param)}", config.{param});\n')
+    rqt_header.write("\t\t\t});\n")
     rqt_header.write("\t\t}\n")
 
     rqt_header.write("\t}\n\n")
@@ -355,7 +479,7 @@ def generate_ros2_rqtreconfigure(settings):
     rqt_header.write("#include <ros_tools/ros2_wrappers.h>\n")
     rqt_header.write("#include <mpc_planner_util/parameters.h>\n")
     rqt_header.write("template <class T>\n")
-    rqt_header.write("bool updateParam(const std::vector<rclcpp::Parameter> &params, const std::string &name, YAML::Node value)\n")
+    rqt_header.write("bool updateParam(const std::vector<rclcpp::Parameter> &params, const std::string &name, ConfigSnapshot &snapshot, const char *weight)\n")
     rqt_header.write("{\n")
     rqt_header.write("\tconst auto itr = std::find_if(\n")
     rqt_header.write("\t\tparams.cbegin(), params.cend(),\n")
@@ -368,8 +492,8 @@ def generate_ros2_rqtreconfigure(settings):
     rqt_header.write("\t\treturn false;\n")
     rqt_header.write("\t}\n")
     rqt_header.write("\n")
-    rqt_header.write("\tvalue = itr->template get_value<T>();\n")
-    rqt_header.write('\tLOG_INFO("Parameter " + name + " set to " + std::to_string(value.as<T>()));\n')
+    rqt_header.write("\tsnapshot.setWeight(weight, itr->template get_value<T>());\n")
+    rqt_header.write('\tLOG_INFO("Parameter " + name + " set to " + std::to_string(snapshot.weight(weight)));\n')
     rqt_header.write("\treturn true;\n")
     rqt_header.write("}\n")
     rqt_header.write("\n")
@@ -391,7 +515,7 @@ def generate_ros2_rqtreconfigure(settings):
 
     for idx, param in enumerate(rqt_params):
         rqt_header.write(
-            f"\t\tnode->declare_parameter<double>(\"{param}\", CONFIG{settings['params'].rqt_param_config_names[idx](param)}.as<double>());\n"
+            f"\t\tnode->declare_parameter<double>(\"{param}\", CONFIG_SNAPSHOT.weight(\"{settings['params'].rqt_param_config_names[idx](param)}\"));\n"
         )
 
     rqt_header.write("\t}\n")
@@ -400,10 +524,14 @@ def generate_ros2_rqtreconfigure(settings):
         "\tvirtual rcl_interfaces::msg::SetParametersResult updateROSParameters(const std::vector<rclcpp::Parameter> &parameters)\n"
     )
     rqt_header.write("\t{\n")
+    rqt_header.write("\t\t// Publish a new configuration snapshot (the planner reads the weights without locking)\n")
+    rqt_header.write("\t\tConfiguration::getInstance().update([&parameters](ConfigSnapshot &snapshot)\n")
+    rqt_header.write("\t\t{\n")
     for idx, param in enumerate(rqt_params):
         rqt_header.write(
-            f"\t\tupdateParam<double>(parameters, \"{param}\", CONFIG{settings['params'].rqt_param_config_names[idx](param)});\n"
+            f"\t\t\tupdateParam<double>(parameters, \"{param}\", snapshot, \"{settings['params'].rqt_param_config_names[idx](param)}\");\n"
         )
+    rqt_header.write("\t\t});\n")
 
     rqt_header.write("\n")
     rqt_header.write("\t\tauto result = rcl_interfaces::msg::SetParametersResult();\n")
@@ -7,7 +7,7 @@ from util.logging import print_success, print_header, print_path
 
 from generate_cpp_files import generate_cpp_code, generate_parameter_cpp_code, generate_module_header, generate_module_cmake
 from generate_cpp_files import generate_module_definitions, generate_rqtreconfigure, generate_module_packagexml
-from generate_cpp_files import generate_ros2_rqtreconfigure, generate_solver_cmake
+from generate_cpp_files import generate_ros2_rqtreconfigure, generate_solver_cmake, generate_layout_header
 
 from generate_acados_solver import generate_acados_solver
 
@@ -34,7 +34,8 @@ def generate_solver(modules, model, settings=None):
 
     generate_cpp_code(settings, model)
     generate_parameter_cpp_code(settings, model)
-    generate_module_header(modules)
+    generate_layout_header(settings, model)
+    generate_module_header(modules, settings)
     generate_module_definitions(modules)
     generate_module_cmake(modules)
     generate_module_packagexml(modules)
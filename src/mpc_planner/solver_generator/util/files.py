@@ -103,6 +103,13 @@ def generated_parameter_include_file(settings):
     return f"{include_path}mpc_planner_parameters.h", f"{src_path}mpc_planner_parameters.cpp"
 
 
+def generated_layout_include_file(settings):
+    include_path = os.path.join(get_package_path("mpc_planner_solver"), f"include/mpc_planner_solver/")
+    os.makedirs(include_path, exist_ok=True)
+    print_path("Generated Layout Header", f"{include_path}mpc_planner_layout.h", tab=True, end="")
+    return f"{include_path}mpc_planner_layout.h"
+
+
 def solver_name(settings):
     return "Solver"
 
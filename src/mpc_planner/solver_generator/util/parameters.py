@@ -26,7 +26,7 @@ class Parameters:
         self,
         parameter,
         add_to_rqt_reconfigure=False,
-        rqt_config_name=lambda p: f'["weights"]["{p}"]',
+        rqt_config_name=lambda p: p,
         bundle_name=None,
         rqt_min_value=0.0,
         rqt_max_value=100.0,
@@ -37,7 +37,7 @@ class Parameters:
         Args:
             parameter (Any): The parameter to be added.
             add_to_rqt_reconfigure (bool, optional): Whether to add the parameter to the RQT Reconfigure. Defaults to False.
-            rqt_config_name (function, optional): A function that returns the name of the parameter in CONFIG for the parameter in RQT Reconfigure. Defaults to lambda p: f'["weights"]["{p}"]'.
+            rqt_config_name (function, optional): A function that returns the name of the weight (under "weights" in the settings) that the parameter in RQT Reconfigure changes. Defaults to lambda p: p.
         """
 
         if parameter in self._params.keys():
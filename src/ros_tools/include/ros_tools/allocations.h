@@ -0,0 +1,88 @@
+#ifndef ros_tools_ALLOCATIONS_H__
+#define ros_tools_ALLOCATIONS_H__
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+#define ALLOCATIONS RosTools::AllocationStatistics::get()
+
+// Opt-in: build ros_tools with TRACK_ALLOCATIONS (ROSTOOLS_TRACK_ALLOCATIONS) to replace the global operator new.
+// Allocations are then counted per thread and attributed to the innermost open PROFILE_SCOPE of that thread.
+namespace RosTools
+{
+    struct AllocationCount
+    {
+        size_t allocations{0};
+        size_t bytes{0};
+    };
+
+    /** @brief True if ros_tools was built with TRACK_ALLOCATIONS */
+    bool allocationTrackingEnabled();
+
+    /** @brief Allocations of the calling thread since it started (zero without tracking) */
+    AllocationCount threadAllocations();
+
+    /**
+     * @brief Attributes the allocations of the calling thread to a scope while it is alive (used by PROFILE_SCOPE).
+     * Allocations in nested scopes count for the nested scope only.
+     */
+    class AllocationScope
+    {
+    public:
+        AllocationScope(const char *name);
+        ~AllocationScope();
+
+        void stop();
+
+    private:
+        const char *_name;
+        AllocationCount _count;
+        AllocationCount *_parent;
+        bool _stopped{false};
+    };
+
+    /** @brief Allocations on the calling thread are not counted while this is alive (e.g., for the profiler itself) */
+    class UntrackedAllocations
+    {
+    public:
+        UntrackedAllocations();
+        ~UntrackedAllocations();
+
+    private:
+        bool _was_untracked;
+    };
+
+    /** @brief Allocations per PROFILE_SCOPE name, over all threads */
+    class AllocationStatistics
+    {
+    public:
+        static AllocationStatistics &get()
+        {
+            static AllocationStatistics instance;
+            return instance;
+        }
+
+        void add(const char *scope, const AllocationCount &count);
+
+        void print();
+        void reset();
+
+    private:
+        struct ScopeStatistics
+        {
+            size_t runs{0};
+            size_t allocations{0}, max_allocations{0};
+            size_t bytes{0};
+        };
+
+        std::map<std::string, ScopeStatistics> _scopes;
+        std::mutex _mutex;
+
+        AllocationStatistics() {}
+        AllocationStatistics(const AllocationStatistics &) = delete;
+        AllocationStatistics &operator=(const AllocationStatistics &) = delete;
+    };
+}
+#endif // ros_tools_ALLOCATIONS_H__
@@ -0,0 +1,125 @@
+#ifndef ros_tools_ASYNC_LOGGING_H_
+#define ros_tools_ASYNC_LOGGING_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+// Log levels below this are compiled out (0 = debug, 1 = info, 2 = warn, 3 = error)
+#ifndef ROSTOOLS_LOG_LEVEL
+#define ROSTOOLS_LOG_LEVEL 0
+#endif
+
+// The level is checked before the message is formatted. Formatting happens on the calling thread into a fixed buffer,
+// the record is then passed through a lock-free queue to a background thread that forwards it to the sink (ROS).
+#define ROSTOOLS_LOG(level, ...)                                                            \
+    do                                                                                      \
+    {                                                                                       \
+        if ((int)(level) >= ROSTOOLS_LOG_LEVEL && RosTools::Logger::enabled(level))         \
+        {                                                                                   \
+            RosTools::Logger &__rostools_logger = RosTools::Logger::get();                 \
+            __rostools_logger.begin() << __VA_ARGS__;                                       \
+            __rostools_logger.end(level);                                                   \
+        }                                                                                   \
+    } while (false)
+
+#define ROSTOOLS_LOG_THROTTLE(rate, level, ...)                                             \
+    do                                                                                      \
+    {                                                                                       \
+        static std::atomic<int64_t> __rostools_last_log{INT64_MIN};                         \
+        if ((int)(level) >= ROSTOOLS_LOG_LEVEL && RosTools::Logger::enabled(level) &&       \
+            RosTools::Logger::throttle(__rostools_last_log, rate))                          \
+        {                                                                                   \
+            RosTools::Logger &__rostools_logger = RosTools::Logger::get();                 \
+            __rostools_logger.begin() << __VA_ARGS__;                                       \
+            __rostools_logger.end(level);                                                   \
+        }                                                                                   \
+    } while (false)
+
+namespace RosTools
+{
+    enum class LogLevel : int
+    {
+        DEBUG = 0,
+        INFO,
+        WARN,
+        ERROR
+    };
+
+    /**
+     * @brief Backend of the LOG_* macros. Messages longer than MESSAGE_SIZE are truncated and messages that do not fit
+     * in the queue are dropped (and counted), logging never blocks the calling thread.
+     * @note Do not log from inside the expression of a log message (the stream of the thread is in use)
+     */
+    class Logger
+    {
+    public:
+        static constexpr size_t MESSAGE_SIZE = 512;
+        static constexpr size_t QUEUE_SIZE = 1024; // Power of two
+
+        using Sink = std::function<void(LogLevel, const char *)>;
+
+        static Logger &get()
+        {
+            static Logger *instance = new Logger(); // Not destroyed, so that logging in static destructors works
+            return *instance;
+        }
+
+        static bool enabled(LogLevel level) { return (int)level >= _level.load(std::memory_order_relaxed); }
+
+        /** @brief True if a message should be logged now, given the time of the last message [ms] */
+        static bool throttle(std::atomic<int64_t> &last_log, double rate);
+
+        void setLevel(LogLevel level) { _level.store((int)level, std::memory_order_relaxed); }
+
+        /** @brief Replace the sink (default: ROS). It is only called from one thread at a time */
+        void setSink(Sink &&sink);
+
+        /** @brief Pass messages to the sink on the calling thread (e.g., to debug a crash) */
+        void setAsynchronous(bool asynchronous) { _asynchronous.store(asynchronous); }
+
+        /** @brief Empty stream of the calling thread to format a message in */
+        std::ostream &begin();
+
+        /** @brief Queue the message formatted since begin() */
+        void end(LogLevel level);
+
+        /** @brief Wait until all queued messages reached the sink */
+        void flush();
+
+    private:
+        struct Record;
+        class Stream;
+
+        static std::atomic<int> _level;
+
+        std::unique_ptr<Record[]> _records;
+        std::atomic<size_t> _enqueue_position{0};
+        std::atomic<size_t> _dequeue_position{0}; // Only written by the background thread
+        std::atomic<size_t> _dropped{0};
+
+        Sink _sink;
+        std::mutex _sink_mutex; // Not taken by the logging threads (unless logging synchronously)
+        std::atomic<bool> _asynchronous{true};
+        std::atomic<bool> _stop{false};
+        std::thread _thread;
+
+        Logger();
+
+        Logger(const Logger &) = delete;
+        Logger &operator=(const Logger &) = delete;
+
+        static Stream &threadStream();
+
+        bool push(LogLevel level, const char *message, size_t length);
+        bool pop();
+        void run();
+        void shutdown();
+    };
+}
+
+#endif // ros_tools_ASYNC_LOGGING_H_
@@ -2,6 +2,8 @@
 #ifndef ros_tools_LOGGING_H_
 #define ros_tools_LOGGING_H_
 
+// Define ROSTOOLS_SYNCHRONOUS_LOGGING to format and pass messages to ROS on the calling thread
+#ifdef ROSTOOLS_SYNCHRONOUS_LOGGING
 #ifdef MPC_PLANNER_ROS
 #include <ros/ros.h>
 #define LOG_INFO(...) ROS_INFO_STREAM(__VA_ARGS__)
@@ -60,6 +62,26 @@ inline void __RCLCPP_INFO_STREAM_THROTTLE(const double rate, const std::string &
 // #define LOG_ERROR_THROTTLE(rate, ...) std::cerr << "Error: " << __VA_ARGS__ << std::endl
 // #define LOG_DEBUG_THROTTLE(rate, ...) std::cout << "Debug: " << __VA_ARGS__ << std::endl
 #endif
+#else
+#ifdef MPC_PLANNER_ROS
+#include <ros/ros.h>
+#else
+#include <rclcpp/logging.hpp>
+#include <rclcpp/clock.hpp>
+#include <ros_tools/ros2_wrappers.h>
+#endif
+#include <ros_tools/async_logging.h>
+
+#define LOG_INFO(...) ROSTOOLS_LOG(RosTools::LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARN(...) ROSTOOLS_LOG(RosTools::LogLevel::WARN, "\033[33m" << __VA_ARGS__ << "\033[0m")
+#define LOG_ERROR(...) ROSTOOLS_LOG(RosTools::LogLevel::ERROR, __VA_ARGS__)
+#define LOG_DEBUG(...) ROSTOOLS_LOG(RosTools::LogLevel::DEBUG, __VA_ARGS__)
+#define LOG_SUCCESS(...) ROSTOOLS_LOG(RosTools::LogLevel::INFO, "\033[32m" << __VA_ARGS__ << "\033[0m")
+#define LOG_INFO_THROTTLE(rate, ...) ROSTOOLS_LOG_THROTTLE(rate, RosTools::LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARN_THROTTLE(rate, ...) ROSTOOLS_LOG_THROTTLE(rate, RosTools::LogLevel::WARN, "\033[33m" << __VA_ARGS__ << "\033[0m")
+#define LOG_ERROR_THROTTLE(rate, ...) ROSTOOLS_LOG_THROTTLE(rate, RosTools::LogLevel::ERROR, __VA_ARGS__)
+#define LOG_DEBUG_THROTTLE(rate, ...) ROSTOOLS_LOG_THROTTLE(rate, RosTools::LogLevel::DEBUG, __VA_ARGS__)
+#endif
 
 #define LOG_VALUE(name, value) LOG_INFO("\033[1m" << name << ":\033[0m " << value)
 #define LOG_VALUE_DEBUG(name, value) LOG_DEBUG("\033[1m" << name << ":\033[0m " << value)
@@ -79,6 +101,9 @@ inline void __ROSTOOLS_ASSERT(const char *expr_str, bool expr, const char *file,
         LOG_ERROR("Assert failed:\t" << msg << "\n"
                                      << "Expected:\t" << expr_str << "\n"
                                      << "Source:\t\t" << file << ", line " << line << "\n");
+#ifndef ROSTOOLS_SYNCHRONOUS_LOGGING
+        RosTools::Logger::get().flush();
+#endif
         abort();
     }
 }
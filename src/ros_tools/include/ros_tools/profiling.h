@@ -1,6 +1,8 @@
 #ifndef ros_tools_PROFILING_H__
 #define ros_tools_PROFILING_H__
 
+#include <ros_tools/allocations.h>
+
 #include <string>
 #include <chrono>
 #include <unordered_map>
@@ -39,6 +41,10 @@ namespace RosTools
 
         int total_runs_ = 0;
 
+        // Heap allocations between start() and stop() on the calling thread (only with TRACK_ALLOCATIONS)
+        AllocationCount start_allocations_;
+        size_t total_allocations_ = 0, max_allocations_ = 0;
+
         std::string name_;
         bool running_ = false;
     };
@@ -52,13 +58,14 @@ namespace RosTools
             return instance;
         }
 
-        Benchmarker &getBenchmarker(std::string benchmark_name)
+        /** @brief Creates the benchmarker on first use. Keep the reference in loops, a lookup hashes the name (and
+         * building the name usually allocates) */
+        Benchmarker &getBenchmarker(const std::string &benchmark_name)
         {
-            if (_benchmarkers.find(benchmark_name) == _benchmarkers.end())
-            {
-                _benchmarkers.insert(std::make_pair(benchmark_name, Benchmarker(benchmark_name)));
-            }
-            return _benchmarkers.at(benchmark_name); // Retrieve the publisher from the map
+            auto it = _benchmarkers.find(benchmark_name);
+            if (it == _benchmarkers.end())
+                it = _benchmarkers.insert(std::make_pair(benchmark_name, Benchmarker(benchmark_name))).first;
+            return it->second;
         }
 
         void print()
@@ -67,6 +74,7 @@ namespace RosTools
             {
                 bm.second.print();
             }
+            ALLOCATIONS.print(); // Per PROFILE_SCOPE (only with TRACK_ALLOCATIONS)
         }
 
     private:
@@ -163,6 +171,7 @@ namespace RosTools
         const char *m_Name;
         std::chrono::system_clock::time_point m_StartTimepoint;
         bool m_Stopped;
+        AllocationScope m_Allocations;
     };
 
 }
@@ -3,6 +3,8 @@
 
 #include <Eigen/Dense>
 
+#include <vector>
+
 namespace MPCPlanner
 {
     class DouglasRachford
@@ -29,6 +31,113 @@ namespace MPCPlanner
             return 2.0 * project(p, delta, r, start_pose) - p;
         }
     };
+
+    /**
+     * @brief Douglas-Rachford projection of a point out of a set of circles (e.g., obstacles at one stage or costmap
+     * cells), with the same passes as calling douglasRachfordProjection for each circle in order.
+     *
+     * Circles further than the cull distance from the point (and from the anchor) are dropped first. A step of a
+     * circle only changes the point if the point is inside the circle or inside the anchor circle of the same radius,
+     * these conditions are checked for the remaining circles at once and only the steps that change the point are
+     * taken. A pass without any step means that the point is collision-free, which ends the projection.
+     */
+    class CircleProjection
+    {
+    public:
+        /**
+         * @param pos Projected in place
+         * @param x, y, radius Circles as structure of arrays (Eigen array expressions, e.g., a column of a matrix)
+         * @param cull_distance Circles are not considered if the point is further than this from their boundary (a
+         * step moves the point by at most twice the radius)
+         * @return The number of passes that changed the point
+         */
+        template <typename DerivedX, typename DerivedY, typename DerivedR>
+        int project(Eigen::Vector2d &pos, const Eigen::ArrayBase<DerivedX> &x, const Eigen::ArrayBase<DerivedY> &y,
+                    const Eigen::ArrayBase<DerivedR> &radius, const Eigen::Vector2d &anchor, double cull_distance,
+                    int max_iterations = 3)
+        {
+            const int n = (int)x.size();
+            if (n == 0)
+                return 0;
+
+            // Cull
+            _x.resize(n);
+            _y.resize(n);
+            _r.resize(n);
+            _slack.resize(n);
+            Eigen::Map<Eigen::ArrayXd>(_slack.data(), n) =
+                ((x - pos(0)).square() + (y - pos(1)).square()).sqrt() - radius;
+            double anchor_distance = (pos - anchor).norm();
+
+            int num_candidates = 0;
+            for (int i = 0; i < n; i++)
+            {
+                if (_slack[i] < cull_distance || anchor_distance - radius(i) < cull_distance)
+                {
+                    _x[num_candidates] = x(i);
+                    _y[num_candidates] = y(i);
+                    _r[num_candidates] = radius(i);
+                    num_candidates++;
+                }
+            }
+
+            // Project
+            int num_passes = 0;
+            for (int iterate = 0; iterate < max_iterations; iterate++)
+            {
+                bool moved = false;
+                int start = 0;
+                while (start < num_candidates)
+                {
+                    int next = nextStep(pos, anchor, start, num_candidates);
+                    if (next < 0)
+                        break;
+
+                    _dr.douglasRachfordProjection(pos, Eigen::Vector2d(_x[next], _y[next]), anchor, _r[next], pos);
+                    moved = true;
+                    start = next + 1;
+                }
+
+                if (!moved) // Collision-free
+                    break;
+                num_passes++;
+            }
+            return num_passes;
+        }
+
+        /** @brief Circles with the same radius */
+        template <typename DerivedX, typename DerivedY>
+        int project(Eigen::Vector2d &pos, const Eigen::ArrayBase<DerivedX> &x, const Eigen::ArrayBase<DerivedY> &y,
+                    double radius, const Eigen::Vector2d &anchor, double cull_distance, int max_iterations = 3)
+        {
+            return project(pos, x, y, Eigen::ArrayXd::Constant(x.size(), radius), anchor, cull_distance, max_iterations);
+        }
+
+    private:
+        DouglasRachford _dr;
+
+        // Candidates after culling (the memory is kept between calls)
+        std::vector<double> _x, _y, _r, _slack;
+
+        /** @brief First candidate in [start, end) whose step changes pos, -1 if there is none */
+        int nextStep(const Eigen::Vector2d &pos, const Eigen::Vector2d &anchor, int start, int end)
+        {
+            const int m = end - start;
+            Eigen::Map<const Eigen::ArrayXd> x(_x.data() + start, m), y(_y.data() + start, m), r(_r.data() + start, m);
+            Eigen::Map<Eigen::ArrayXd> slack(_slack.data(), m);
+
+            // Negative if pos is inside the circle or inside the anchor circle with its radius (squared distances)
+            double anchor_distance_sq = (pos - anchor).squaredNorm();
+            slack = ((x - pos(0)).square() + (y - pos(1)).square()).min(anchor_distance_sq) - r.square();
+
+            for (int i = 0; i < m; i++)
+            {
+                if (slack(i) < 0.)
+                    return start + i;
+            }
+            return -1;
+        }
+    };
 }
 
 #endif // PROJECTION_H
\ No newline at end of file
@@ -8,6 +8,7 @@
 #ifdef MPC_PLANNER_ROS
 
 #include <ros_tools/ros_visuals.h>
+#include <mutex>
 #include <unordered_map>
 
 class Visuals
@@ -25,8 +26,10 @@ public:
         _nh = nh;
     }
 
+    // Publishers can be retrieved from multiple threads (e.g., a visualization thread), each publisher from one thread
     RosTools::ROSMarkerPublisher &getPublisher(const std::string &topic_name)
     {
+        std::lock_guard<std::mutex> lock(_mutex);
         if (_publishers.find(topic_name) == _publishers.end())
         {
             std::string node_topic_name = _name + std::string("/") + topic_name;
@@ -37,6 +40,7 @@ public:
 
 private:
     std::unordered_map<std::string, RosTools::ROSMarkerPublisher> _publishers;
+    std::mutex _mutex;
 
     std::string _name{""};
     ros::NodeHandle *_nh; // ROS1
@@ -52,6 +56,7 @@ private:
 #else
 #include <ros_tools/ros_visuals.h>
 #include <rclcpp/node.hpp>
+#include <mutex>
 
 class Visuals
 {
@@ -68,8 +73,10 @@ public:
         _node = node;
     }
 
+    // Publishers can be retrieved from multiple threads (e.g., a visualization thread), each publisher from one thread
     RosTools::ROSMarkerPublisher &getPublisher(std::string topic_name)
     {
+        std::lock_guard<std::mutex> lock(_mutex);
         if (_publishers.find(topic_name) == _publishers.end())
         {
             std::string node_topic_name = _node->get_name() + std::string("/") + topic_name;
@@ -84,6 +91,7 @@ private:
     std::unordered_map<std::string, RosTools::ROSMarkerPublisher> _publishers;
 
     rclcpp::Node *_node{nullptr}; // Necessary for ROS2
+    std::mutex _mutex;
 
     std::string frame_id{"map"};
 
@@ -0,0 +1,161 @@
+#include "ros_tools/allocations.h"
+
+#include <ros_tools/logging.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    // Per thread: all allocations, the counter of the innermost open scope and whether counting is paused
+    thread_local RosTools::AllocationCount thread_count;
+    thread_local RosTools::AllocationCount *scope_count = nullptr;
+    thread_local bool untracked = false;
+
+#ifdef ROSTOOLS_TRACK_ALLOCATIONS
+    // All replacement operators allocate and free here (over-aligned blocks come from aligned_alloc, which free releases)
+    void *trackedAllocation(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+    {
+        if (!untracked)
+        {
+            thread_count.allocations++;
+            thread_count.bytes += size;
+            if (scope_count)
+            {
+                scope_count->allocations++;
+                scope_count->bytes += size;
+            }
+        }
+
+        if (size == 0)
+            size = 1;
+
+        if (alignment <= alignof(std::max_align_t))
+            return std::malloc(size);
+
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment); // A multiple of the alignment
+    }
+
+    void *throwingAllocation(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+    {
+        void *ptr = trackedAllocation(size, alignment);
+        if (!ptr)
+            throw std::bad_alloc();
+        return ptr;
+    }
+
+    void trackedFree(void *ptr) noexcept
+    {
+        std::free(ptr);
+    }
+#endif
+}
+
+#ifdef ROSTOOLS_TRACK_ALLOCATIONS
+void *operator new(std::size_t size) { return throwingAllocation(size); }
+void *operator new[](std::size_t size) { return throwingAllocation(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return trackedAllocation(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return trackedAllocation(size); }
+
+void *operator new(std::size_t size, std::align_val_t alignment) { return throwingAllocation(size, (std::size_t)alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return throwingAllocation(size, (std::size_t)alignment); }
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return trackedAllocation(size, (std::size_t)alignment);
+}
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return trackedAllocation(size, (std::size_t)alignment);
+}
+
+void operator delete(void *ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { trackedFree(ptr); }
+
+void operator delete(void *ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { trackedFree(ptr); }
+#endif
+
+namespace RosTools
+{
+    bool allocationTrackingEnabled()
+    {
+#ifdef ROSTOOLS_TRACK_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    AllocationCount threadAllocations() { return thread_count; }
+
+    UntrackedAllocations::UntrackedAllocations() : _was_untracked(untracked) { untracked = true; }
+    UntrackedAllocations::~UntrackedAllocations() { untracked = _was_untracked; }
+
+    AllocationScope::AllocationScope(const char *name) : _name(name), _parent(scope_count)
+    {
+        if (allocationTrackingEnabled())
+            scope_count = &_count;
+    }
+
+    AllocationScope::~AllocationScope()
+    {
+        if (!_stopped)
+            stop();
+    }
+
+    void AllocationScope::stop()
+    {
+        _stopped = true;
+        if (!allocationTrackingEnabled())
+            return;
+
+        scope_count = _parent;
+        ALLOCATIONS.add(_name, _count);
+    }
+
+    void AllocationStatistics::add(const char *scope, const AllocationCount &count)
+    {
+        UntrackedAllocations untracked_scope; // A new entry allocates
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto &statistics = _scopes[scope];
+        statistics.runs++;
+        statistics.allocations += count.allocations;
+        statistics.max_allocations = std::max(statistics.max_allocations, count.allocations);
+        statistics.bytes += count.bytes;
+    }
+
+    void AllocationStatistics::print()
+    {
+        if (!allocationTrackingEnabled())
+            return;
+
+        UntrackedAllocations untracked_scope;
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto &scope : _scopes)
+        {
+            const ScopeStatistics &statistics = scope.second;
+
+            LOG_DIVIDER();
+            LOG_VALUE("Allocations in", scope.first);
+            LOG_VALUE("Average (per run)", (double)statistics.allocations / (double)statistics.runs);
+            LOG_VALUE("Max (per run)", statistics.max_allocations);
+            LOG_VALUE("Average bytes (per run)", (double)statistics.bytes / (double)statistics.runs);
+        }
+    }
+
+    void AllocationStatistics::reset()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _scopes.clear();
+    }
+}
@@ -0,0 +1,274 @@
+#include "ros_tools/async_logging.h"
+
+#ifdef MPC_PLANNER_ROS
+#include <ros/ros.h>
+#else
+#include <rclcpp/logging.hpp>
+#include <ros_tools/ros2_wrappers.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <streambuf>
+
+namespace RosTools
+{
+    namespace
+    {
+        void rosSink(LogLevel level, const char *message)
+        {
+#ifdef MPC_PLANNER_ROS
+            switch (level)
+            {
+            case LogLevel::DEBUG:
+                ROS_DEBUG_STREAM(message);
+                break;
+            case LogLevel::INFO:
+                ROS_INFO_STREAM(message);
+                break;
+            case LogLevel::WARN:
+                ROS_WARN_STREAM(message);
+                break;
+            case LogLevel::ERROR:
+                ROS_ERROR_STREAM(message);
+                break;
+            }
+#else
+            rclcpp::Logger logger = rclcpp::get_logger("ros_tools");
+            try
+            {
+                logger = GET_STATIC_NODE_POINTER()->get_logger();
+            }
+            catch (const std::runtime_error &) // The node was not set (yet)
+            {
+            }
+
+            switch (level)
+            {
+            case LogLevel::DEBUG:
+                RCLCPP_DEBUG_STREAM(logger, message);
+                break;
+            case LogLevel::INFO:
+                RCLCPP_INFO_STREAM(logger, message);
+                break;
+            case LogLevel::WARN:
+                RCLCPP_WARN_STREAM(logger, message);
+                break;
+            case LogLevel::ERROR:
+                RCLCPP_ERROR_STREAM(logger, message);
+                break;
+            }
+#endif
+        }
+
+        // At shutdown ROS may already be gone
+        void consoleSink(LogLevel level, const char *message)
+        {
+            if (level >= LogLevel::WARN)
+                std::cerr << message << std::endl;
+            else
+                std::cout << message << std::endl;
+        }
+    }
+
+    struct Logger::Record
+    {
+        std::atomic<size_t> sequence;
+        LogLevel level;
+        size_t length;
+        char message[MESSAGE_SIZE];
+    };
+
+    /** @brief Formats into a fixed buffer (no allocations), the rest of a long message is discarded */
+    class Logger::Stream : public std::streambuf
+    {
+    public:
+        Stream() : _stream(this) { reset(); }
+
+        std::ostream &reset()
+        {
+            setp(_buffer, _buffer + MESSAGE_SIZE - 1); // Keep space for the terminating zero
+            _stream.clear();
+            return _stream;
+        }
+
+        const char *data() const { return pbase(); }
+        size_t size() const { return pptr() - pbase(); }
+
+        const char *c_str()
+        {
+            *pptr() = '\0';
+            return pbase();
+        }
+
+    protected:
+        int_type overflow(int_type c) override
+        {
+            (void)c;
+            return traits_type::eof();
+        }
+
+    private:
+        char _buffer[MESSAGE_SIZE];
+        std::ostream _stream;
+    };
+
+    std::atomic<int> Logger::_level{(int)LogLevel::INFO};
+
+    Logger::Logger() : _records(new Record[QUEUE_SIZE]), _sink(rosSink)
+    {
+        static_assert((QUEUE_SIZE & (QUEUE_SIZE - 1)) == 0, "The log queue size should be a power of two");
+        for (size_t i = 0; i < QUEUE_SIZE; i++)
+            _records[i].sequence.store(i, std::memory_order_relaxed);
+
+#ifdef MPC_PLANNER_ROS
+        ROSCONSOLE_AUTOINIT; // Before registering the exit handler, so that rosconsole outlives it
+#endif
+        _thread = std::thread(&Logger::run, this);
+        std::atexit([]()
+                    { Logger::get().shutdown(); });
+    }
+
+    // On exit, the remaining and later messages go to the console synchronously
+    void Logger::shutdown()
+    {
+        _stop.store(true);
+        if (_thread.joinable())
+            _thread.join();
+
+        std::lock_guard<std::mutex> lock(_sink_mutex);
+        _sink = consoleSink;
+        while (pop())
+        {
+        }
+        _asynchronous.store(false);
+    }
+
+    bool Logger::throttle(std::atomic<int64_t> &last_log, double rate)
+    {
+        int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+
+        int64_t last = last_log.load(std::memory_order_relaxed);
+        if (last != INT64_MIN && (double)(now - last) < rate)
+            return false;
+
+        return last_log.compare_exchange_strong(last, now, std::memory_order_relaxed); // One thread logs
+    }
+
+    void Logger::setSink(Sink &&sink)
+    {
+        std::lock_guard<std::mutex> lock(_sink_mutex);
+        _sink = std::move(sink);
+    }
+
+    Logger::Stream &Logger::threadStream()
+    {
+        thread_local Stream stream; // Constructed on the first message of a thread
+        return stream;
+    }
+
+    std::ostream &Logger::begin()
+    {
+        return threadStream().reset();
+    }
+
+    void Logger::end(LogLevel level)
+    {
+        Stream &stream = threadStream();
+
+        if (_asynchronous.load(std::memory_order_relaxed))
+        {
+            push(level, stream.data(), stream.size());
+            return;
+        }
+
+        flush(); // Keep the order of the queued messages
+        std::lock_guard<std::mutex> lock(_sink_mutex);
+        _sink(level, stream.c_str());
+    }
+
+    void Logger::flush()
+    {
+        if (std::this_thread::get_id() == _thread.get_id())
+            return;
+
+        size_t queued = _enqueue_position.load();
+        while (_dequeue_position.load() < queued && _thread.joinable() && !_stop.load())
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    // Bounded multi-producer queue (D. Vyukov), each record holds the position at which it can be written or read
+    bool Logger::push(LogLevel level, const char *message, size_t length)
+    {
+        size_t position = _enqueue_position.load(std::memory_order_relaxed);
+        Record *record;
+        for (;;)
+        {
+            record = &_records[position & (QUEUE_SIZE - 1)];
+            size_t sequence = record->sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+            if (difference == 0)
+            {
+                if (_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (difference < 0) // Full
+            {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                position = _enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+
+        record->level = level;
+        record->length = std::min(length, MESSAGE_SIZE - 1);
+        std::memcpy(record->message, message, record->length);
+        record->message[record->length] = '\0';
+        record->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Single consumer (the background thread, or shutdown() after it stopped), call with the sink mutex
+    bool Logger::pop()
+    {
+        size_t position = _dequeue_position.load(std::memory_order_relaxed);
+        Record &record = _records[position & (QUEUE_SIZE - 1)];
+        if (record.sequence.load(std::memory_order_acquire) != position + 1)
+            return false;
+
+        _sink(record.level, record.message);
+
+        record.sequence.store(position + QUEUE_SIZE, std::memory_order_release);
+        _dequeue_position.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    void Logger::run()
+    {
+        while (!_stop.load())
+        {
+            bool received = false;
+            {
+                std::lock_guard<std::mutex> lock(_sink_mutex);
+                while (pop())
+                    received = true;
+
+                size_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+                if (dropped > 0)
+                    _sink(LogLevel::WARN, ("Logging queue full, dropped " + std::to_string(dropped) + " messages").c_str());
+            }
+
+            if (!received)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
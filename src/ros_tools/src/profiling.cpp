@@ -3,6 +3,7 @@
 #include <ros_tools/logging.h>
 #include <ros_tools/paths.h>
 
+#include <algorithm>
 #include <thread>
 
 namespace RosTools
@@ -22,11 +23,18 @@ namespace RosTools
         LOG_VALUE("Timing of", name_);
         LOG_VALUE("Average (ms)", average_run_time);
         LOG_VALUE("Max (ms)", max_duration_ * 1000.0);
+
+        if (allocationTrackingEnabled())
+        {
+            LOG_VALUE("Average allocations", (double)total_allocations_ / (double)total_runs_);
+            LOG_VALUE("Max allocations", max_allocations_);
+        }
     }
 
     void Benchmarker::start()
     {
         running_ = true;
+        start_allocations_ = threadAllocations();
         start_time_ = std::chrono::system_clock::now();
     }
 
@@ -43,6 +51,10 @@ namespace RosTools
         auto end_time = std::chrono::system_clock::now();
         std::chrono::duration<double> current_duration = end_time - start_time_;
 
+        size_t allocations = threadAllocations().allocations - start_allocations_.allocations;
+        total_allocations_ += allocations;
+        max_allocations_ = std::max(max_allocations_, allocations);
+
         if (current_duration.count() < min_duration_)
             min_duration_ = current_duration.count();
 
@@ -68,6 +80,8 @@ namespace RosTools
         min_duration_ = 99999.0;
         last_ = -1.0;
         total_runs_ = 0;
+        total_allocations_ = 0;
+        max_allocations_ = 0;
         running_ = false;
     }
 
@@ -113,6 +127,7 @@ namespace RosTools
 
     void Instrumentor::WriteProfile(const ProfileResult &result)
     {
+        UntrackedAllocations untracked; // Not attributed to the profiled code
         std::lock_guard<std::mutex> lock(m_lock);
 
         if (m_ProfileCount++ > 0)
@@ -146,7 +161,7 @@ namespace RosTools
         m_OutputStream.flush();
     }
 
-    InstrumentationTimer::InstrumentationTimer(const char *name) : m_Name(name), m_Stopped(false) { m_StartTimepoint = std::chrono::system_clock::now(); }
+    InstrumentationTimer::InstrumentationTimer(const char *name) : m_Name(name), m_Stopped(false), m_Allocations(name) { m_StartTimepoint = std::chrono::system_clock::now(); }
 
     InstrumentationTimer::~InstrumentationTimer()
     {
@@ -157,6 +172,7 @@ namespace RosTools
     void InstrumentationTimer::Stop()
     {
         auto endTimepoint = std::chrono::system_clock::now();
+        m_Allocations.stop();
 
         long long start = std::chrono::time_point_cast<std::chrono::microseconds>(m_StartTimepoint).time_since_epoch().count();
         long long end = std::chrono::time_point_cast<std::chrono::microseconds>(endTimepoint).time_since_epoch().count();
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <ros_tools/projection.h>
+
+#include <cstdlib>
+#include <limits>
+
+using namespace MPCPlanner;
+
+// The projection as it was done before CircleProjection: every step, for every circle, in order
+Eigen::Vector2d projectEachCircle(Eigen::Vector2d pos, const Eigen::ArrayXd &x, const Eigen::ArrayXd &y,
+                                  const Eigen::ArrayXd &radius, const Eigen::Vector2d &anchor, int max_iterations = 3)
+{
+    DouglasRachford dr;
+    for (int iterate = 0; iterate < max_iterations; iterate++)
+    {
+        for (int i = 0; i < x.size(); i++)
+            dr.douglasRachfordProjection(pos, Eigen::Vector2d(x(i), y(i)), anchor, radius(i), pos);
+    }
+    return pos;
+}
+
+TEST(CircleProjectionTest, MatchesDouglasRachfordLoop)
+{
+    std::srand(1);
+    CircleProjection projection; // Reused, as in the modules
+
+    int num_moved = 0;
+    for (int trial = 0; trial < 2000; trial++)
+    {
+        // Obstacles at three stages, the middle stage is projected
+        int n = 1 + std::rand() % 40;
+        Eigen::ArrayXXd x = Eigen::ArrayXXd::Random(n, 3) * 5.;
+        Eigen::ArrayXXd y = Eigen::ArrayXXd::Random(n, 3) * 5.;
+        Eigen::ArrayXd radius = Eigen::ArrayXd::Random(n).abs() + 0.3;
+
+        const int k = 1;
+        Eigen::Vector2d start = Eigen::Vector2d::Random() * 5.;
+        Eigen::Vector2d anchor(x(0, k), y(0, k));
+
+        Eigen::Vector2d expected = projectEachCircle(start, x.col(k), y.col(k), radius, anchor);
+        if ((expected - start).norm() > 1e-9)
+            num_moved++;
+
+        Eigen::Vector2d pos = start;
+        projection.project(pos, x.col(k), y.col(k), radius, anchor, std::numeric_limits<double>::infinity());
+        ASSERT_NEAR((pos - expected).norm(), 0., 1e-9) << "trial " << trial;
+
+        // Culling at twice the largest radius drops only circles that cannot change the point
+        pos = start;
+        projection.project(pos, x.col(k), y.col(k), radius, anchor, 2. * radius.maxCoeff());
+        ASSERT_NEAR((pos - expected).norm(), 0., 1e-9) << "trial " << trial << " (culled)";
+    }
+    ASSERT_GT(num_moved, 100); // The trials are not all collision-free
+}
+
+TEST(CircleProjectionTest, StridedPointsWithOneRadius)
+{
+    std::srand(2);
+    std::vector<Eigen::Vector2d> points(100);
+    for (auto &point : points)
+        point = Eigen::Vector2d::Random() * 3.;
+
+    // Costmap cells as an array of structures
+    Eigen::Map<const Eigen::ArrayXd, 0, Eigen::InnerStride<2>> x(&points[0](0), points.size());
+    Eigen::Map<const Eigen::ArrayXd, 0, Eigen::InnerStride<2>> y(&points[0](1), points.size());
+
+    Eigen::Vector2d start(0.1, 0.2);
+    Eigen::Vector2d expected = projectEachCircle(start, x, y, Eigen::ArrayXd::Constant(points.size(), 0.4), points[0]);
+    ASSERT_GT((expected - start).norm(), 1e-9);
+
+    CircleProjection projection;
+    Eigen::Vector2d pos = start;
+    projection.project(pos, x, y, 0.4, points[0], 1e9);
+    ASSERT_NEAR((pos - expected).norm(), 0., 1e-9);
+}
+
+TEST(CircleProjectionTest, StopsWhenCollisionFree)
+{
+    Eigen::ArrayXd x(2), y(2);
+    x << 5., -5.;
+    y << 0., 0.;
+
+    CircleProjection projection;
+    Eigen::Vector2d pos(0., 0.);
+    ASSERT_EQ(projection.project(pos, x, y, 1., Eigen::Vector2d(0., 1.), 1e9), 0);
+    ASSERT_EQ(pos, Eigen::Vector2d(0., 0.));
+
+    ASSERT_EQ(projection.project(pos, Eigen::ArrayXd(), Eigen::ArrayXd(), 1., pos, 1e9), 0);
+}
+
+// Run all the tests
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}